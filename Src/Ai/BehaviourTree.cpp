@@ -0,0 +1,99 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "BehaviourTree.h"
+
+#include "base/Macros.h" // for RioAssert
+
+namespace RioGame
+{
+
+	BehaviourTree::BehaviourTree(std::string name, std::vector<BehaviourNode>&& nodes, std::vector<std::string>&& strings)
+		: name{ std::move(name) }
+		, nodes{ std::move(nodes) }
+		, strings{ std::move(strings) }
+	{
+		RioAssert(!this->nodes.empty(), "Empty behaviour tree");
+	}
+
+	BehaviourStatus BehaviourTree::execute(BehaviourContext& context) const
+	{
+		// Indices of the composite nodes on the path from the root to the current node
+		std::array<uint16_t, maxDepth> stack;
+		int32_t top = -1;
+		uint32_t current = 0;
+
+		for (;;)
+		{
+			const BehaviourNode& node = this->nodes[current];
+			if (node.operation != BehaviourNode::LEAF)
+			{
+				// Descend into the first child
+				RioAssert(top + 1 < (int32_t)maxDepth, "Behaviour tree too deep");
+				stack[++top] = (uint16_t)current;
+				++current;
+				continue;
+			}
+
+			BehaviourStatus status = node.leaf(context, node, this->strings);
+			uint32_t finished = current;
+
+			// Pass the status up until a composite wants to continue with the next sibling
+			for (;;)
+			{
+				if (top < 0)
+				{
+					return status;
+				}
+
+				uint32_t parentIndex = stack[top];
+				const BehaviourNode& parent = this->nodes[parentIndex];
+				uint32_t sibling = this->nodes[finished].end;
+				bool done = true;
+
+				switch (parent.operation)
+				{
+				case BehaviourNode::SELECTOR:
+					done = status != BehaviourStatus::FAILURE || sibling == parent.end;
+					break;
+				case BehaviourNode::SEQUENCE:
+					done = status != BehaviourStatus::SUCCESS || sibling == parent.end;
+					break;
+				case BehaviourNode::INVERTER:
+					if (status != BehaviourStatus::RUNNING)
+					{
+						status = status == BehaviourStatus::SUCCESS ? BehaviourStatus::FAILURE : BehaviourStatus::SUCCESS;
+					}
+					break;
+				case BehaviourNode::SUCCEEDER:
+					if (status != BehaviourStatus::RUNNING)
+					{
+						status = BehaviourStatus::SUCCESS;
+					}
+					break;
+				default:
+					break;
+				}
+
+				if (!done)
+				{
+					current = sibling;
+					break;
+				}
+
+				finished = parentIndex;
+				--top;
+			}
+		}
+	}
+
+	const std::string& BehaviourTree::getName() const
+	{
+		return this->name;
+	}
+
+	uint32_t BehaviourTree::getNodeCount() const
+	{
+		return (uint32_t)this->nodes.size();
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,88 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace RioGame
+{
+
+	class EntityManager;
+
+	enum class BehaviourStatus : uint8_t
+	{
+		SUCCESS = 0,
+		FAILURE,
+		RUNNING
+	};
+
+	// Per entity memory of a behaviour tree, fixed size so that all blackboards fit in one array
+	struct Blackboard
+	{
+		static constexpr uint32_t slotCount = 8;
+
+		std::array<float, slotCount> slots{};
+		uint32_t entity = uint32_t(-1);
+	};
+
+	// Everything a leaf node can access while it's being evaluated
+	struct BehaviourContext
+	{
+		EntityManager& entityManager;
+		Blackboard& blackboard;
+		uint32_t entity;
+	};
+
+	struct BehaviourNode;
+
+	// Conditions and actions are plain functions resolved when a tree is compiled,
+	// so the evaluation never goes through std::function
+	using BehaviourLeaf = BehaviourStatus(*)(BehaviourContext&, const BehaviourNode&, const std::vector<std::string>& strings);
+
+	struct BehaviourNode
+	{
+		static constexpr uint16_t NO_STRING = uint16_t(-1);
+
+		enum Operation : uint8_t
+		{
+			LEAF = 0,
+			SELECTOR,
+			SEQUENCE,
+			INVERTER,
+			SUCCEEDER
+		};
+
+		BehaviourLeaf leaf = nullptr;
+		std::array<float, 2> args{};
+		// One past the last node of this node's subtree (nodes are stored in pre-order)
+		uint16_t end = 0;
+		// Index into the tree's string table for leaves with a name argument
+		uint16_t string = NO_STRING;
+		Operation operation = LEAF;
+	};
+
+	// Behaviour tree compiled into a flat array of nodes in pre-order, children of a node
+	// directly follow it and the subtree's end index allows to skip to its next sibling
+	// Trees are immutable once compiled and are shared by all entities of a blueprint
+	class BehaviourTree
+	{
+	public:
+		static constexpr uint32_t maxDepth = 32;
+
+		BehaviourTree(std::string name, std::vector<BehaviourNode>&& nodes, std::vector<std::string>&& strings);
+
+		// Evaluates the tree from the root for a single entity
+		BehaviourStatus execute(BehaviourContext& context) const;
+
+		const std::string& getName() const;
+		uint32_t getNodeCount() const;
+	private:
+		std::string name;
+		std::vector<BehaviourNode> nodes;
+		std::vector<std::string> strings;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
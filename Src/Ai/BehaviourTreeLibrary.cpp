@@ -0,0 +1,445 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "BehaviourTreeLibrary.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include "base/Macros.h" // for RioAssert
+
+#include "Components.h"
+#include "EntityManager.h"
+
+namespace RioGame
+{
+
+	namespace
+	{
+		BehaviourStatus fromBool(bool value)
+		{
+			return value ? BehaviourStatus::SUCCESS : BehaviourStatus::FAILURE;
+		}
+
+		uint32_t toSlot(float value)
+		{
+			// Converting a negative, NaN or too big float is undefined, the comparisons are false for NaN
+			if (!(value > 0.0f))
+			{
+				return 0;
+			}
+			return value < (float)(Blackboard::slotCount - 1) ? (uint32_t)value : Blackboard::slotCount - 1;
+		}
+
+		BehaviourStatus hasTarget(BehaviourContext& context, const BehaviourNode&, const std::vector<std::string>&)
+		{
+			auto combat = context.entityManager.getComponent<CombatComponent>(context.entity);
+			return fromBool(combat != nullptr && combat->currentTarget != Component::NO_ENTITY);
+		}
+
+		// args[0] is the percentage of the max health
+		BehaviourStatus healthBelow(BehaviourContext& context, const BehaviourNode& node, const std::vector<std::string>&)
+		{
+			auto health = context.entityManager.getComponent<HealthComponent>(context.entity);
+			return fromBool(health != nullptr && health->currentHealthPoints * 100.0f < node.args[0] * health->maxHealthPoints);
+		}
+
+		BehaviourStatus isBusy(BehaviourContext& context, const BehaviourNode&, const std::vector<std::string>&)
+		{
+			auto taskHandler = context.entityManager.getComponent<TaskHandlerComponent>(context.entity);
+			return fromBool(taskHandler != nullptr && taskHandler->busy);
+		}
+
+		BehaviourStatus hasTasks(BehaviourContext& context, const BehaviourNode&, const std::vector<std::string>&)
+		{
+			auto taskHandler = context.entityManager.getComponent<TaskHandlerComponent>(context.entity);
+			return fromBool(taskHandler != nullptr
+				&& (taskHandler->currentTask != Component::NO_ENTITY || !taskHandler->taskQueue.empty()));
+		}
+
+		// args[0] is the blackboard slot, args[1] the value it's compared to
+		BehaviourStatus blackboardAtLeast(BehaviourContext& context, const BehaviourNode& node, const std::vector<std::string>&)
+		{
+			return fromBool(context.blackboard.slots[toSlot(node.args[0])] >= node.args[1]);
+		}
+
+		// args[0] is the blackboard slot, args[1] the value that is stored in it
+		BehaviourStatus setBlackboard(BehaviourContext& context, const BehaviourNode& node, const std::vector<std::string>&)
+		{
+			context.blackboard.slots[toSlot(node.args[0])] = node.args[1];
+			return BehaviourStatus::SUCCESS;
+		}
+
+		// Calls the function of the entity's AiComponent blueprint named by the node
+		BehaviourStatus callBlueprint(BehaviourContext& context, const BehaviourNode& node, const std::vector<std::string>& strings)
+		{
+			auto ai = context.entityManager.getComponent<AiComponent>(context.entity);
+			if (ai == nullptr)
+			{
+				return BehaviourStatus::FAILURE;
+			}
+
+			if (node.string >= strings.size())
+			{
+				return BehaviourStatus::FAILURE;
+			}
+
+			auto function = ai->blueprint.find(strings[node.string]);
+			if (function == ai->blueprint.end() || !function->second)
+			{
+				return BehaviourStatus::FAILURE;
+			}
+
+			function->second();
+			return BehaviourStatus::SUCCESS;
+		}
+
+		BehaviourStatus idle(BehaviourContext&, const BehaviourNode&, const std::vector<std::string>&)
+		{
+			return BehaviourStatus::SUCCESS;
+		}
+
+		// Tree being parsed, nodes are kept with their children until the tree gets flattened
+		struct TreeBuilder
+		{
+			struct ParsedNode
+			{
+				BehaviourNode node;
+				std::vector<uint32_t> children;
+				uint32_t line;
+			};
+
+			std::string name;
+			std::vector<ParsedNode> parsed;
+			std::vector<std::string> strings;
+			// Indentation and index of the nodes on the path to the last parsed node
+			std::vector<std::pair<uint32_t, uint32_t>> path;
+		};
+
+		[[noreturn]] void fail(const std::string& sourceName, uint32_t line, const std::string& message)
+		{
+			throw std::runtime_error{ sourceName + ":" + std::to_string(line) + ": " + message };
+		}
+
+		void flatten(const std::string& sourceName, const TreeBuilder& builder
+			, uint32_t index, uint32_t depth, std::vector<BehaviourNode>& nodes)
+		{
+			const auto& parsed = builder.parsed[index];
+			if (depth >= BehaviourTree::maxDepth)
+			{
+				fail(sourceName, parsed.line, "behaviour tree too deep");
+			}
+
+			uint32_t position = (uint32_t)nodes.size();
+			nodes.push_back(parsed.node);
+			for (auto child : parsed.children)
+			{
+				flatten(sourceName, builder, child, depth + 1, nodes);
+			}
+
+			if (nodes.size() > std::numeric_limits<uint16_t>::max())
+			{
+				fail(sourceName, parsed.line, "behaviour tree has too many nodes");
+			}
+			nodes[position].end = (uint16_t)nodes.size();
+		}
+	}
+
+	Blackboard& BlackboardPool::acquire(uint32_t entity)
+	{
+		auto it = this->indices.find(entity);
+		if (it != this->indices.end())
+		{
+			return this->blackboards[it->second];
+		}
+
+		this->indices.emplace(entity, (uint32_t)this->blackboards.size());
+		this->blackboards.emplace_back();
+		this->blackboards.back().entity = entity;
+		return this->blackboards.back();
+	}
+
+	void BlackboardPool::release(uint32_t entity)
+	{
+		auto it = this->indices.find(entity);
+		if (it == this->indices.end())
+		{
+			return;
+		}
+
+		// Keeps the pool dense by moving the last blackboard into the freed place
+		uint32_t index = it->second;
+		this->indices.erase(it);
+		if (index != this->blackboards.size() - 1)
+		{
+			this->blackboards[index] = this->blackboards.back();
+			this->indices[this->blackboards[index].entity] = index;
+		}
+		this->blackboards.pop_back();
+	}
+
+	void BlackboardPool::collect(EntityManager& entityManager, uint32_t maxChecks)
+	{
+		for (uint32_t i = 0; i < maxChecks && !this->blackboards.empty(); ++i)
+		{
+			if (this->collectCursor >= this->blackboards.size())
+			{
+				this->collectCursor = 0;
+			}
+
+			uint32_t entity = this->blackboards[this->collectCursor].entity;
+			if (!entityManager.hasComponent<AiComponent>(entity))
+			{
+				// The last blackboard moved to the cursor, so it gets checked next
+				release(entity);
+			}
+			else
+			{
+				++this->collectCursor;
+			}
+		}
+	}
+
+	void BlackboardPool::clear()
+	{
+		this->blackboards.clear();
+		this->indices.clear();
+		this->collectCursor = 0;
+	}
+
+	BehaviourTreeLibrary::BehaviourTreeLibrary()
+	{
+		registerLeaf("HAS_TARGET", &hasTarget);
+		registerLeaf("HEALTH_BELOW", &healthBelow);
+		registerLeaf("IS_BUSY", &isBusy);
+		registerLeaf("HAS_TASKS", &hasTasks);
+		registerLeaf("BLACKBOARD_AT_LEAST", &blackboardAtLeast);
+		registerLeaf("SET", &setBlackboard);
+		registerLeaf("CALL", &callBlueprint, true);
+		registerLeaf("IDLE", &idle);
+	}
+
+	void BehaviourTreeLibrary::registerLeaf(const std::string& name, BehaviourLeaf leaf, bool needsName)
+	{
+		this->leaves[name] = Leaf{ leaf, needsName };
+	}
+
+	void BehaviourTreeLibrary::loadFromFile(const std::string& path)
+	{
+		std::ifstream file{ path };
+		if (!file)
+		{
+			throw std::runtime_error{ "Could not open behaviour tree file " + path };
+		}
+
+		std::stringstream source;
+		source << file.rdbuf();
+		loadFromString(source.str(), path);
+	}
+
+	void BehaviourTreeLibrary::loadFromString(const std::string& source, const std::string& sourceName)
+	{
+		std::vector<TreeBuilder> builders;
+		std::istringstream lines{ source };
+		std::string line;
+		uint32_t lineNumber = 0;
+
+		while (std::getline(lines, line))
+		{
+			++lineNumber;
+			line = line.substr(0, line.find('#'));
+
+			uint32_t indentation = 0;
+			size_t first = 0;
+			for (; first < line.size() && (line[first] == ' ' || line[first] == '\t'); ++first)
+			{
+				indentation += line[first] == '\t' ? 4 : 1;
+			}
+
+			std::istringstream tokens{ line.substr(first) };
+			std::string keyword;
+			if (!(tokens >> keyword))
+			{
+				continue;
+			}
+
+			if (keyword == "tree")
+			{
+				builders.emplace_back();
+				if (!(tokens >> builders.back().name))
+				{
+					fail(sourceName, lineNumber, "tree without a name");
+				}
+				continue;
+			}
+
+			if (builders.empty())
+			{
+				fail(sourceName, lineNumber, "node outside of a tree");
+			}
+
+			TreeBuilder& builder = builders.back();
+			TreeBuilder::ParsedNode parsed{};
+			parsed.line = lineNumber;
+
+			if (keyword == "selector")
+			{
+				parsed.node.operation = BehaviourNode::SELECTOR;
+			}
+			else if (keyword == "sequence")
+			{
+				parsed.node.operation = BehaviourNode::SEQUENCE;
+			}
+			else if (keyword == "inverter")
+			{
+				parsed.node.operation = BehaviourNode::INVERTER;
+			}
+			else if (keyword == "succeeder")
+			{
+				parsed.node.operation = BehaviourNode::SUCCEEDER;
+			}
+			else if (keyword == "condition" || keyword == "action")
+			{
+				std::string leafName;
+				tokens >> leafName;
+				auto leaf = this->leaves.find(leafName);
+				if (leaf == this->leaves.end())
+				{
+					fail(sourceName, lineNumber, "unknown leaf '" + leafName + "'");
+				}
+				parsed.node.leaf = leaf->second.function;
+
+				uint32_t argCount = 0;
+				std::string argument;
+				while (tokens >> argument)
+				{
+					char* numberEnd = nullptr;
+					float number = std::strtof(argument.c_str(), &numberEnd);
+					if (*numberEnd == '\0' && argCount < parsed.node.args.size())
+					{
+						parsed.node.args[argCount++] = number;
+					}
+					else if (parsed.node.string != BehaviourNode::NO_STRING)
+					{
+						fail(sourceName, lineNumber, "leaf '" + leafName + "' has more than one name");
+					}
+					else if (builder.strings.size() >= BehaviourNode::NO_STRING)
+					{
+						fail(sourceName, lineNumber, "tree '" + builder.name + "' has too many names");
+					}
+					else
+					{
+						parsed.node.string = (uint16_t)builder.strings.size();
+						builder.strings.push_back(argument);
+					}
+				}
+
+				if (leaf->second.needsName && parsed.node.string == BehaviourNode::NO_STRING)
+				{
+					fail(sourceName, lineNumber, "leaf '" + leafName + "' needs a name");
+				}
+			}
+			else
+			{
+				fail(sourceName, lineNumber, "unknown node '" + keyword + "'");
+			}
+
+			// The parent is the closest node on the path with a smaller indentation
+			while (!builder.path.empty() && builder.path.back().first >= indentation)
+			{
+				builder.path.pop_back();
+			}
+
+			uint32_t index = (uint32_t)builder.parsed.size();
+			if (builder.path.empty())
+			{
+				if (!builder.parsed.empty())
+				{
+					fail(sourceName, lineNumber, "tree '" + builder.name + "' has more than one root");
+				}
+			}
+			else
+			{
+				auto& parent = builder.parsed[builder.path.back().second];
+				if (parent.node.operation == BehaviourNode::LEAF)
+				{
+					fail(sourceName, lineNumber, "leaves can't have children");
+				}
+				parent.children.push_back(index);
+			}
+
+			builder.parsed.push_back(std::move(parsed));
+			builder.path.emplace_back(indentation, index);
+		}
+
+		// Trees are only replaced once the whole file compiled
+		std::vector<std::unique_ptr<BehaviourTree>> compiled;
+		for (auto& builder : builders)
+		{
+			if (builder.parsed.empty())
+			{
+				fail(sourceName, lineNumber, "tree '" + builder.name + "' is empty");
+			}
+
+			for (const auto& parsed : builder.parsed)
+			{
+				auto operation = parsed.node.operation;
+				bool isDecorator = operation == BehaviourNode::INVERTER || operation == BehaviourNode::SUCCEEDER;
+				if (operation != BehaviourNode::LEAF && parsed.children.empty())
+				{
+					fail(sourceName, parsed.line, "composite without children");
+				}
+				if (isDecorator && parsed.children.size() != 1)
+				{
+					fail(sourceName, parsed.line, "decorators need exactly one child");
+				}
+			}
+
+			std::vector<BehaviourNode> nodes;
+			nodes.reserve(builder.parsed.size());
+			flatten(sourceName, builder, 0, 0, nodes);
+			compiled.emplace_back(new BehaviourTree{ builder.name, std::move(nodes), std::move(builder.strings) });
+		}
+
+		for (auto& tree : compiled)
+		{
+			auto id = this->treeIds.find(tree->getName());
+			if (id != this->treeIds.end())
+			{
+				this->trees[id->second] = std::move(tree);
+			}
+			else
+			{
+				this->treeIds.emplace(tree->getName(), (uint32_t)this->trees.size());
+				this->trees.push_back(std::move(tree));
+			}
+		}
+	}
+
+	uint32_t BehaviourTreeLibrary::getTreeId(const std::string& name) const
+	{
+		auto id = this->treeIds.find(name);
+		return id != this->treeIds.end() ? id->second : NO_TREE;
+	}
+
+	const BehaviourTree& BehaviourTreeLibrary::getTree(uint32_t id) const
+	{
+		RioAssert(id < this->trees.size(), "Invalid behaviour tree id");
+		return *this->trees[id];
+	}
+
+	BehaviourStatus BehaviourTreeLibrary::execute(uint32_t tree, uint32_t entity, EntityManager& entityManager)
+	{
+		BehaviourContext context{ entityManager, this->blackboards.acquire(entity), entity };
+		return getTree(tree).execute(context);
+	}
+
+	BlackboardPool& BehaviourTreeLibrary::getBlackboards()
+	{
+		return this->blackboards;
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,86 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "BehaviourTree.h"
+
+namespace RioGame
+{
+
+	class EntityManager;
+
+	// Contiguous storage of the blackboards of all entities driven by behaviour trees
+	class BlackboardPool
+	{
+	public:
+		// Returns the entity's blackboard, creating a cleared one if it has none
+		Blackboard& acquire(uint32_t entity);
+		void release(uint32_t entity);
+		// Releases the blackboards of entities that lost their AiComponent,
+		// checks at most maxChecks blackboards per call and continues where it left off
+		void collect(EntityManager& entityManager, uint32_t maxChecks);
+		void clear();
+	private:
+		std::vector<Blackboard> blackboards;
+		std::unordered_map<uint32_t, uint32_t> indices;
+		uint32_t collectCursor = 0;
+	};
+
+	// Owns the compiled behaviour trees (shared by all entities using them) and the leaf functions
+	// Trees are loaded from data files, every tree starts with "tree <name>" followed by its nodes,
+	// nesting is given by indentation (a tab counts as four spaces), '#' starts a comment:
+	//
+	// tree minion
+	//     selector
+	//         sequence
+	//             condition HAS_TARGET
+	//             action CALL attack
+	//         action IDLE
+	//
+	// Composites are selector and sequence, decorators (one child) are inverter and succeeder,
+	// condition and action lines name a registered leaf followed by up to two numbers and one name
+	class BehaviourTreeLibrary
+	{
+	public:
+		static constexpr uint32_t NO_TREE = uint32_t(-1);
+
+		// Registers the built-in leaves
+		BehaviourTreeLibrary();
+		BehaviourTreeLibrary(const BehaviourTreeLibrary&) = delete;
+		BehaviourTreeLibrary& operator=(const BehaviourTreeLibrary&) = delete;
+
+		// Registers a condition or action that trees can reference by name (must happen before loading),
+		// nodes of leaves that need a name are rejected without one
+		void registerLeaf(const std::string& name, BehaviourLeaf leaf, bool needsName = false);
+		// Compiles all trees in the file, a tree with an already known name replaces the old one and keeps its id
+		// Throws std::runtime_error on malformed data
+		void loadFromFile(const std::string& path);
+		void loadFromString(const std::string& source, const std::string& sourceName = "<string>");
+
+		// Returns the id of the tree with the given name or NO_TREE
+		uint32_t getTreeId(const std::string& name) const;
+		const BehaviourTree& getTree(uint32_t id) const;
+		// Evaluates the tree for the given entity using its blackboard
+		BehaviourStatus execute(uint32_t tree, uint32_t entity, EntityManager& entityManager);
+
+		BlackboardPool& getBlackboards();
+	private:
+		struct Leaf
+		{
+			BehaviourLeaf function;
+			bool needsName;
+		};
+
+		std::unordered_map<std::string, Leaf> leaves;
+		std::vector<std::unique_ptr<BehaviourTree>> trees;
+		std::unordered_map<std::string, uint32_t> treeIds;
+		BlackboardPool blackboards;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
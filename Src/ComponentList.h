@@ -0,0 +1,105 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstdint>
+
+// Every component type and its ComponentType name in the order of their ids
+// A new component is only added here, its id, its ComponentType entry and its traits follow from its position
+#define RIO_GAME_COMPONENTS(X) \
+	X(ActivationComponent, ACTIVATION) \
+	X(AiComponent, AI) \
+	X(AlignComponent, ALIGN) \
+	X(AnimationComponent, ANIMATION) \
+	X(CombatComponent, COMBAT) \
+	X(CommandComponent, COMMAND) \
+	X(CounterComponent, COUNTER) \
+	X(ConstructorComponent, CONSTRUCTOR) \
+	X(CrystalManaComponent, CRYSTAL_MANA) \
+	X(DestructorComponent, DESTRUCTOR) \
+	X(DummyAlignComponent, DUMMY_ALIGN_COMPONENT) \
+	X(EventComponent, EVENT) \
+	X(EventHandlerComponent, EVENT_HANDLER) \
+	X(ExperienceValueComponent, EXPERIENCE_VALUE) \
+	X(ExplosionComponent, EXPLOSION) \
+	X(HealthComponent, HEALTH) \
+	X(HomingComponent, HOMING) \
+	X(GoldComponent, GOLD) \
+	X(GraphicsComponent, GRAPHICS) \
+	X(GridNodeComponent, GRID_NODE) \
+	X(FactionComponent, FACTION) \
+	X(InputComponent, INPUT) \
+	X(LimitedLifeSpanComponent, LIMITED_LIFE_SPAN) \
+	X(ManaComponent, MANA) \
+	X(MineComponent, MINE) \
+	X(MovementComponent, MOVEMENT) \
+	X(NameComponent, NAME) \
+	X(NotificationComponent, NOTIFICATION) \
+	X(OnHitComponent, ON_HIT) \
+	X(PathfindingComponent, PATHFINDING) \
+	X(PhysicsComponent, PHYSICS) \
+	X(PortalComponent, PORTAL) \
+	X(PriceComponent, PRICE) \
+	X(ProductComponent, PRODUCT) \
+	X(ProductionComponent, PRODUCTION) \
+	X(SelectionComponent, SELECTION) \
+	X(SpellComponent, SPELL) \
+	X(StructureComponent, STRUCTURE) \
+	X(TaskComponent, TASK) \
+	X(TaskHandlerComponent, TASK_HANDLER) \
+	X(TimeComponent, TIME) \
+	X(TriggerComponent, TRIGGER) \
+	X(UpgradeComponent, UPGRADE)
+
+namespace RioGame
+{
+
+#define RIO_GAME_DECLARE_COMPONENT(Type, name) struct Type;
+	RIO_GAME_COMPONENTS(RIO_GAME_DECLARE_COMPONENT)
+#undef RIO_GAME_DECLARE_COMPONENT
+
+	template<typename... Ts>
+	struct TypeList
+	{
+		static constexpr uint32_t size = sizeof...(Ts);
+	};
+
+	template<typename List>
+	struct PopFront;
+
+	template<typename T, typename... Ts>
+	struct PopFront<TypeList<T, Ts...>>
+	{
+		using Type = TypeList<Ts...>;
+	};
+
+	template<typename T, typename List>
+	struct IndexOf;
+
+	template<typename T, typename... Ts>
+	struct IndexOf<T, TypeList<T, Ts...>>
+	{
+		static constexpr uint32_t value = 0;
+	};
+
+	template<typename T, typename U, typename... Ts>
+	struct IndexOf<T, TypeList<U, Ts...>>
+	{
+		static constexpr uint32_t value = 1 + IndexOf<T, TypeList<Ts...>>::value;
+	};
+
+	// All component types in the order of their ids (the leading void only swallows the first comma)
+#define RIO_GAME_COMPONENT_TYPE(Type, name) , Type
+	using ComponentTypes = PopFront<TypeList<void RIO_GAME_COMPONENTS(RIO_GAME_COMPONENT_TYPE)>>::Type;
+#undef RIO_GAME_COMPONENT_TYPE
+
+	constexpr uint32_t componentCount = ComponentTypes::size;
+
+	// Id of a component type, usable while the component is still incomplete (for its own T::type)
+	template<typename T>
+	struct ComponentId
+	{
+		static constexpr int value = (int)IndexOf<T, ComponentTypes>::value;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
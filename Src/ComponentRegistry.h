@@ -0,0 +1,94 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "ComponentList.h"
+#include "Components.h"
+#include "Enums.h"
+
+namespace RioGame
+{
+
+	// Passed to the functions called by forEachComponentType
+	template<typename T>
+	struct TypeTag
+	{
+		using Type = T;
+	};
+
+	// Compile time information about a component type
+	template<typename T>
+	struct ComponentTraits
+	{
+		static constexpr uint32_t id = (uint32_t)ComponentId<T>::value;
+		static constexpr ComponentType type = (ComponentType)id;
+		static constexpr size_t size = sizeof(T);
+		static constexpr size_t alignment = alignof(T);
+		// Trivially copyable components can be copied and serialized with memcpy
+		static constexpr bool triviallyCopyable = std::is_trivially_copyable<T>::value;
+	};
+
+	// Run time view of the traits, indexed by component id
+	struct ComponentInfo
+	{
+		size_t size;
+		size_t alignment;
+		bool triviallyCopyable;
+	};
+
+	template<typename Function, typename... Ts>
+	void forEachComponentType(Function&& function, TypeList<Ts...>)
+	{
+		int expand[] = { 0, (function(TypeTag<Ts>{}), 0)... };
+		(void)expand;
+	}
+
+	// Calls function(TypeTag<T>{}) for every component type in id order
+	template<typename Function>
+	void forEachComponentType(Function&& function)
+	{
+		forEachComponentType(function, ComponentTypes{});
+	}
+
+	template<typename... Ts>
+	const ComponentInfo* getComponentInfos(TypeList<Ts...>)
+	{
+		static const ComponentInfo infos[] = {
+			ComponentInfo{ ComponentTraits<Ts>::size, ComponentTraits<Ts>::alignment, ComponentTraits<Ts>::triviallyCopyable }...
+		};
+		return infos;
+	}
+
+	inline const ComponentInfo& getComponentInfo(uint32_t id)
+	{
+		return getComponentInfos(ComponentTypes{})[id];
+	}
+
+	// Copies count components, a single memcpy for trivially copyable ones
+	template<typename T>
+	void copyComponents(T* destination, const T* source, size_t count, std::true_type)
+	{
+		std::memcpy(destination, source, count * sizeof(T));
+	}
+
+	template<typename T>
+	void copyComponents(T* destination, const T* source, size_t count, std::false_type)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			destination[i] = source[i];
+		}
+	}
+
+	template<typename T>
+	void copyComponents(T* destination, const T* source, size_t count)
+	{
+		copyComponents(destination, source, count, std::integral_constant<bool, ComponentTraits<T>::triviallyCopyable>{});
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
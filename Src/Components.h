@@ -15,7 +15,9 @@
 
 #define CACHE_ALLOWED 1
 
+#include "ComponentList.h"
 #include "Enums.h"
+#include "Tools/InlineContainers.h"
 
 #include "math/Vec2.h"
 #include "math/Vec3.h"
@@ -32,7 +34,7 @@ namespace RioGame
 
 	struct Component
 	{
-		static constexpr int count = 44;
+		static constexpr int count = (int)componentCount;
 		static constexpr uint32_t NO_ENTITY = std::numeric_limits<uint32_t>::max();
 	};
 
@@ -44,7 +46,7 @@ namespace RioGame
 	// the player to switch between the two states of an entity using a button in the entity viewer
 	struct ActivationComponent
 	{
-		static constexpr int type = 0;
+		static constexpr int type = ComponentId<ActivationComponent>::value;
 
 		std::map<std::string, std::function<void()>> blueprint;
 		bool activated = false;
@@ -63,10 +65,13 @@ namespace RioGame
 
 	struct AiComponent
 	{
-		static constexpr int type = 1;
+		static constexpr int type = ComponentId<AiComponent>::value;
 
 		std::map<std::string, std::function<void()>> blueprint;
 		EntityState::ENUM state;
+		// Id of the shared behaviour tree in the World's BehaviourTreeLibrary (the blueprint's Ai.tree),
+		// the AiSystem thinks for the entity instead if there is none
+		uint32_t behaviourTree = uint32_t(-1);
 
 		AiComponent(std::map<std::string, std::function<void()>>&& blueprint, EntityState::ENUM entityState = EntityState::NORMAL)
 			: blueprint{ std::move(blueprint) }
@@ -83,7 +88,7 @@ namespace RioGame
 	// Align states: scale, sprite, etc for the different alignments of blocks (e.g. walls)
 	struct AlignComponent
 	{
-		static constexpr int type = 2;
+		static constexpr int type = ComponentId<AlignComponent>::value;
 		static constexpr int stateCount = 6;
 
 		struct AlignState
@@ -103,16 +108,17 @@ namespace RioGame
 		~AlignComponent() = default;
 	};
 
-	struct AnimationState
-	{
-		// Dummy
-	};
-
+	// Playback state of an entity, the clips themselves are shared by all entities of a blueprint
+	// (see AnimationLibrary), the shown frame is computed from the start time when needed
 	struct AnimationComponent
 	{
-		static constexpr int type = 3;
+		static constexpr int type = ComponentId<AnimationComponent>::value;
+		static constexpr uint32_t NO_CLIP = std::numeric_limits<uint32_t>::max();
 
-		AnimationState* currentAnimation = nullptr;
+		// Clips of the entity's blueprint
+		uint32_t clipSet = NO_CLIP;
+		uint32_t clip = NO_CLIP;
+		float startTime = 0.0f;
 		std::bitset<AnimationType::COUNT> possibleAnimationList;
 		bool stopCurrentAnimation = true;
 
@@ -127,7 +133,7 @@ namespace RioGame
 	// Entity's attack types and damage
 	struct CombatComponent
 	{
-		static constexpr int type = 4;
+		static constexpr int type = ComponentId<CombatComponent>::value;
 
 		uint32_t currentTarget;
 		uint32_t minDamage;
@@ -169,7 +175,7 @@ namespace RioGame
 	// Contains a list of commands an entity can respond to
 	struct CommandComponent
 	{
-		static constexpr int type = 5;
+		static constexpr int type = ComponentId<CommandComponent>::value;
 
 		std::bitset<(uint32_t)CommandType::COUNT> possibleCommandList;
 
@@ -185,7 +191,7 @@ namespace RioGame
 	// The max value is not enforced and serves only for manual checking
 	struct CounterComponent
 	{
-		static constexpr int type = 6;
+		static constexpr int type = ComponentId<CounterComponent>::value;
 
 		uint32_t currentValue = (uint32_t)(-1);
 		uint32_t maxValue;
@@ -204,7 +210,7 @@ namespace RioGame
 	// Contains the blueprint that gets called when an entity that has this component is created
 	struct ConstructorComponent
 	{
-		static constexpr int type = 7;
+		static constexpr int type = ComponentId<ConstructorComponent>::value;
 
 		std::map<std::string, std::function<void()>> blueprint;
 
@@ -222,7 +228,7 @@ namespace RioGame
 	// Allows an entity to increase the player's mana capacity and regeneration rate while it's alive
 	struct CrystalManaComponent
 	{
-		static constexpr int type = 8;
+		static constexpr int type = ComponentId<CrystalManaComponent>::value;
 
 		uint32_t capIncrease;
 		uint32_t regenIncrease;
@@ -243,7 +249,7 @@ namespace RioGame
 	// (called "dtor") which is called when an entity is destroyed
 	struct DestructorComponent
 	{
-		static constexpr int type = 9;
+		static constexpr int type = ComponentId<DestructorComponent>::value;
 
 		std::map<std::string, std::function<void()>> blueprint;
 
@@ -262,14 +268,14 @@ namespace RioGame
 	// to use the full geometry e.g. for doors to avoid artefacts on the neighbour blocks
 	struct DummyAlignComponent
 	{
-		static constexpr int type = 10;
+		static constexpr int type = ComponentId<DummyAlignComponent>::value;
 	};
 
 	// Represents events that happen in the game, like dropping gold,
 	// curing an entity of poisoning or triggers from traps, etc
 	struct EventComponent
 	{
-		static constexpr int type = 11;
+		static constexpr int type = ComponentId<EventComponent>::value;
 
 		EventType eventType;
 		uint32_t target;
@@ -297,7 +303,7 @@ namespace RioGame
 	// (Also, only entities with this component will react to events)
 	struct EventHandlerComponent
 	{
-		static constexpr int type = 12;
+		static constexpr int type = ComponentId<EventHandlerComponent>::value;
 
 		std::string handler;
 		std::bitset<(uint32_t)EventType::COUNT> possibleEventList;
@@ -317,7 +323,7 @@ namespace RioGame
 	// The amount of experience the entity yields when killed
 	struct ExperienceValueComponent
 	{
-		static constexpr int type = 13;
+		static constexpr int type = ComponentId<ExperienceValueComponent>::value;
 
 		uint32_t value;
 
@@ -336,7 +342,7 @@ namespace RioGame
 	// the damage should be done in the explosion's constructor so that it's not applied on each frame
 	struct ExplosionComponent
 	{
-		static constexpr int type = 14;
+		static constexpr int type = ComponentId<ExplosionComponent>::value;
 
 		float delta;
 		float maxRadius;
@@ -357,7 +363,7 @@ namespace RioGame
 	// Health and regeneration
 	struct HealthComponent
 	{
-		static constexpr int type = 15;
+		static constexpr int type = ComponentId<HealthComponent>::value;
 
 		uint32_t currentHealthPoints;
 		uint32_t maxHealthPoints;
@@ -387,7 +393,7 @@ namespace RioGame
 	// Used for projectiles that are supposed to follow a target and deal damage when they hit it
 	struct HomingComponent
 	{
-		static constexpr int type = 16;
+		static constexpr int type = ComponentId<HomingComponent>::value;
 
 		uint32_t source;
 		uint32_t target;
@@ -411,7 +417,7 @@ namespace RioGame
 	// Represents a gold amount an entity is holding, be it a gold seam, worker minion or gold depository
 	struct GoldComponent
 	{
-		static constexpr int type = 17;
+		static constexpr int type = ComponentId<GoldComponent>::value;
 
 		uint32_t maxAmount;
 		uint32_t currentAmount;
@@ -430,7 +436,7 @@ namespace RioGame
 
 	struct GraphicsComponent
 	{
-		static constexpr int type = 18;
+		static constexpr int type = ComponentId<GraphicsComponent>::value;
 
 		std::string sprite;
 		bool visible;
@@ -464,7 +470,7 @@ namespace RioGame
 	// nodes so the A* algorithm will ignore them)
 	struct GridNodeComponent
 	{
-		static constexpr int type = 19;
+		static constexpr int type = ComponentId<GridNodeComponent>::value;
 		static constexpr uint32_t neighbourCount = 9;
 
 		std::array<uint32_t, neighbourCount> neighbours;
@@ -499,7 +505,7 @@ namespace RioGame
 	// Represents the faction an entity that has this component if a member of
 	struct FactionComponent
 	{
-		static constexpr int type = 20;
+		static constexpr int type = ComponentId<FactionComponent>::value;
 
 		Faction faction;
 
@@ -517,7 +523,7 @@ namespace RioGame
 	// Direct player input applied to an entity
 	struct InputComponent
 	{
-		static constexpr int type = 21;
+		static constexpr int type = ComponentId<InputComponent>::value;
 
 		std::string inputHandler;
 
@@ -536,7 +542,7 @@ namespace RioGame
 	// after a certain amount of time has passed (lifespan)
 	struct LimitedLifeSpanComponent
 	{
-		static constexpr int type = 22;
+		static constexpr int type = ComponentId<LimitedLifeSpanComponent>::value;
 
 		float currentTime = 0.0f;
 		float maxTime;
@@ -555,7 +561,7 @@ namespace RioGame
 	// Allows an entity to cast spell by providing the mana resource
 	struct ManaComponent
 	{
-		static constexpr int type = 23;
+		static constexpr int type = ComponentId<ManaComponent>::value;
 
 		uint32_t currentMana;
 		uint32_t maxMana;
@@ -577,7 +583,7 @@ namespace RioGame
 	// Dummy component that signals that an entity having it can be mined
 	struct MineComponent
 	{
-		static constexpr int type = 24;
+		static constexpr int type = ComponentId<MineComponent>::value;
 	};
 
 	// Holds info related to movement, if an entity has this component it should also
@@ -585,7 +591,7 @@ namespace RioGame
 	// MovementSystem might not work correctly
 	struct MovementComponent
 	{
-		static constexpr int type = 25;
+		static constexpr int type = ComponentId<MovementComponent>::value;
 
 		float speedModifier;
 		float originalSpeed;
@@ -605,7 +611,7 @@ namespace RioGame
 	// Name of the entity shown in the entity viewer
 	struct NameComponent
 	{
-		static constexpr int type = 26;
+		static constexpr int type = ComponentId<NameComponent>::value;
 
 		std::string name;
 
@@ -624,7 +630,7 @@ namespace RioGame
 	// doesn't spam the player with messages on reoccuring events in a short time period
 	struct NotificationComponent
 	{
-		static constexpr int type = 27;
+		static constexpr int type = ComponentId<NotificationComponent>::value;
 
 		float currentTime = 0.0f;
 		float cooldown;
@@ -643,7 +649,7 @@ namespace RioGame
 	// Contains the blueprint table which gets called when an entity that has this component gets hit
 	struct OnHitComponent
 	{
-		static constexpr int type = 28;
+		static constexpr int type = ComponentId<OnHitComponent>::value;
 
 		std::map<std::string, std::function<void()>> blueprint;
 		float currentTime;
@@ -665,11 +671,12 @@ namespace RioGame
 	// Holds data related to the entity's current path
 	struct PathfindingComponent
 	{
-		static constexpr int type = 29;
+		static constexpr int type = ComponentId<PathfindingComponent>::value;
 
 		uint32_t targetId;
 		uint32_t lastId;
-		std::deque<uint32_t> pathQueue;
+		// Paths up to 16 nodes stay inside the component
+		InlineDeque<uint32_t, 16> pathQueue;
 		// Name of the table the getCost(id1, id2) function is in
 		std::map<std::string, std::function<void()>> blueprint; 
 
@@ -689,7 +696,7 @@ namespace RioGame
 
 	struct PhysicsComponent
 	{
-		static constexpr int type = 30;
+		static constexpr int type = ComponentId<PhysicsComponent>::value;
 
 		bool solid;
 		Vec2 position;
@@ -711,13 +718,13 @@ namespace RioGame
 	// An entity having it is a portal, used in pathfinding
 	struct PortalComponent
 	{
-		static constexpr int type = 31;
+		static constexpr int type = ComponentId<PortalComponent>::value;
 	};
 
 	// Represents either gold or mana cost of an entity.
 	struct PriceComponent
 	{
-		static constexpr int type = 32;
+		static constexpr int type = ComponentId<PriceComponent>::value;
 
 		uint32_t price;
 
@@ -736,7 +743,7 @@ namespace RioGame
 	// (Producer is the building/tile that spawned it)
 	struct ProductComponent
 	{
-		static constexpr int type = 33;
+		static constexpr int type = ComponentId<ProductComponent>::value;
 
 		uint32_t producer;
 
@@ -754,7 +761,7 @@ namespace RioGame
 	// Allows scheduled production of new entities (spawners) of a given type up to a maximum amount
 	struct ProductionComponent
 	{
-		static constexpr int type = 34;
+		static constexpr int type = ComponentId<ProductionComponent>::value;
 
 		std::string productBlueprint;
 		uint32_t currentProduced = 0;
@@ -778,7 +785,7 @@ namespace RioGame
 	// Allows an entity to be selected and select/deselect handler blueprint
 	struct SelectionComponent
 	{
-		static constexpr int type = 35;
+		static constexpr int type = ComponentId<SelectionComponent>::value;
 
 		std::map<std::string, std::function<void()>> blueprint;
 		Vec2 scale;
@@ -807,7 +814,7 @@ namespace RioGame
 	// Allows an entity to periodically cast a spell
 	struct SpellComponent
 	{
-		static constexpr int type = 36;
+		static constexpr int type = ComponentId<SpellComponent>::value;
 
 		std::map<std::string, std::function<void()>> blueprint;
 		float cooldownTime = 0.0f;
@@ -829,11 +836,12 @@ namespace RioGame
 	// in the grid) and vector of nodes that it sits on
 	struct StructureComponent
 	{
-		static constexpr int type = 37;
+		static constexpr int type = ComponentId<StructureComponent>::value;
 
 		uint32_t radius;
 		bool isWalkThrough;
-		std::vector<uint32_t> residences;
+		// Nodes of a building with radius 1 (3x3) stay inside the component
+		InlineVector<uint32_t, 9> residences;
 
 		StructureComponent(uint32_t r = 1, bool wt = false)
 			: radius{ r }
@@ -852,7 +860,7 @@ namespace RioGame
 	// Handling of these tasks is done via the TaskHandlerComponent below
 	struct TaskComponent
 	{
-		static constexpr int type = 38;
+		static constexpr int type = ComponentId<TaskComponent>::value;
 
 		TaskType taskType;
 		uint32_t source;
@@ -879,11 +887,11 @@ namespace RioGame
 	// able to actually do something on it's own should have it.
 	struct TaskHandlerComponent
 	{
-		static constexpr int type = 39;
+		static constexpr int type = ComponentId<TaskHandlerComponent>::value;
 
 		uint32_t currentTask = Component::NO_ENTITY;
 		std::bitset<(uint32_t)TaskType::COUNT> possibleTaskList;
-		std::deque<uint32_t> taskQueue;
+		InlineDeque<uint32_t, 8> taskQueue;
 		bool busy = false;
 		std::map<std::string, std::function<void()>> blueprint;
 
@@ -901,7 +909,7 @@ namespace RioGame
 	// Represents a timer that after a certain amount of time can start end an event (it's target)
 	struct TimeComponent
 	{
-		static constexpr int type = 40;
+		static constexpr int type = ComponentId<TimeComponent>::value;
 
 		float currentTime = 0.0f;
 		float timeLimit;
@@ -928,7 +936,7 @@ namespace RioGame
 	// its triggered (stepped on) or can notify a linked entity which causes the effect
 	struct TriggerComponent
 	{
-		static constexpr int type = 41;
+		static constexpr int type = ComponentId<TriggerComponent>::value;
 
 		std::map<std::string, std::function<void()>> blueprint;
 		uint32_t linkedEntity = Component::NO_ENTITY;
@@ -953,7 +961,7 @@ namespace RioGame
 	// and leveling progression as well as the blueprint that gets called on level up
 	struct UpgradeComponent
 	{
-		static constexpr int type = 42;
+		static constexpr int type = ComponentId<UpgradeComponent>::value;
 
 		std::map<std::string, std::function<void()>> blueprint;
 		uint32_t experience = 0;
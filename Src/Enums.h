@@ -1,6 +1,8 @@
 // Copyright (c) 2012-2017 Volodymyr Syvochka
 #pragma once
 
+#include "ComponentList.h"
+
 namespace RioGame
 {
 
@@ -82,6 +84,21 @@ namespace RioGame
 		COUNT
 	};
 
+	// Kinds of deadlines registered in the World's TimingWheel, each kind has one handler
+	enum class TimerType
+	{
+		TIME_EVENT = 0,
+		LIFE_SPAN,
+		NOTIFICATION_COOLDOWN,
+		ON_HIT_COOLDOWN,
+		SPELL_COOLDOWN,
+		TRIGGER_COOLDOWN,
+		PRODUCTION_COOLDOWN,
+		// Health and mana regeneration of all entities and the player
+		REGEN_TICK,
+		COUNT
+	};
+
 	namespace Direction
 	{
 		enum ENUM
@@ -168,50 +185,11 @@ namespace RioGame
 
 	enum class ComponentType 
 	{
-		NONE =					-1,
-		ACTIVATION =			0,
-		AI =					1,
-		ALIGN =					2,
-		ANIMATION =				3,
-		COMBAT =				4,
-		COMMAND =				5,
-		COUNTER =				6,
-		CONSTRUCTOR =			7,
-		CRYSTAL_MANA =			8,
-		DESTRUCTOR =			9,
-		DUMMY_ALIGN_COMPONENT = 10,
-		EVENT =					11,
-		EVENT_HANDLER =			12,
-		EXPERIENCE_VALUE =		13,
-		EXPLOSION =				14,
-		HEALTH =				15,
-		HOMING =				16,
-		GOLD =					17,
-		GRAPHICS =				18,
-		GRID_NODE =				19,
-		FACTION =				20,
-		INPUT =					21,
-		LIMITED_LIFE_SPAN =		22,
-		MANA =					23,
-		MINE =					24,
-		MOVEMENT =				25,
-		NAME =					26,
-		NOTIFICATION =			27,
-		ON_HIT =				28,
-		PATHFINDING =			29,
-		PHYSICS =				30,
-		PORTAL =				31,
-		PRICE =					32,
-		PRODUCT =				33,
-		PRODUCTION =			34,
-		SELECTION =				35,
-		SPELL =					36,
-		STRUCTURE =				37,
-		TASK =					38,
-		TASK_HANDLER =			39,
-		TIME =					40,
-		TRIGGER =				41,
-		UPGRADE =				42,
+		NONE = -1,
+		// Same order as the component ids
+#define RIO_GAME_COMPONENT_NAME(Type, name) name,
+		RIO_GAME_COMPONENTS(RIO_GAME_COMPONENT_NAME)
+#undef RIO_GAME_COMPONENT_NAME
 	};
 
 	enum class InputKeyType 
@@ -0,0 +1,350 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "ChunkedLevelGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/Macros.h" // for RioAssert
+
+#include "Components.h"
+#include "EntityManager.h"
+#include "Tools/ThreadPool.h"
+
+namespace RioGame
+{
+
+	namespace LevelGenerators
+	{
+
+		namespace
+		{
+			uint64_t mix(uint64_t value)
+			{
+				// splitmix64 finalizer
+				value += 0x9e3779b97f4a7c15ull;
+				value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+				value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+				return value ^ (value >> 31);
+			}
+
+			uint64_t hashPosition(uint32_t seed, uint32_t x, uint32_t y, uint32_t salt)
+			{
+				return mix(mix(((uint64_t)seed << 32) | salt) ^ (((uint64_t)x << 32) | y));
+			}
+
+			// Random numbers of a single chunk
+			class ChunkRandom
+			{
+			public:
+				ChunkRandom(uint64_t seed)
+					: state{ seed }
+				{
+				}
+
+				uint32_t next(uint32_t bound)
+				{
+					this->state = mix(this->state);
+					return (uint32_t)((this->state >> 32) % bound);
+				}
+
+				float nextFloat()
+				{
+					this->state = mix(this->state);
+					return (float)(this->state >> 40) / (float)(1 << 24);
+				}
+			private:
+				uint64_t state;
+			};
+
+			float smooth(float t)
+			{
+				return t * t * (3.0f - 2.0f * t);
+			}
+
+			// Value noise in [0, 1) with lattice points cellSize tiles apart
+			float valueNoise(uint32_t seed, uint32_t octave, uint32_t x, uint32_t y, float cellSize)
+			{
+				float fx = x / cellSize;
+				float fy = y / cellSize;
+				uint32_t ix = (uint32_t)fx;
+				uint32_t iy = (uint32_t)fy;
+				float tx = smooth(fx - ix);
+				float ty = smooth(fy - iy);
+
+				auto lattice = [seed, octave](uint32_t lx, uint32_t ly)
+				{
+					return (float)(hashPosition(seed, lx, ly, octave) >> 40) / (float)(1 << 24);
+				};
+				float top = lattice(ix, iy) + (lattice(ix + 1, iy) - lattice(ix, iy)) * tx;
+				float bottom = lattice(ix, iy + 1) + (lattice(ix + 1, iy + 1) - lattice(ix, iy + 1)) * tx;
+				return top + (bottom - top) * ty;
+			}
+
+			bool isPassable(Tile tile)
+			{
+				return tile == Tile::FREE || tile == Tile::PORTAL;
+			}
+		}
+
+		ChunkedLevelGenerator::ChunkedLevelGenerator(ThreadPool& threadPool, const LevelSettings& settings)
+			: threadPool{ threadPool }
+			, settings{ settings }
+		{
+		}
+
+		void ChunkedLevelGenerator::setSettings(const LevelSettings& settings)
+		{
+			this->settings = settings;
+		}
+
+		const LevelSettings& ChunkedLevelGenerator::getSettings() const
+		{
+			return this->settings;
+		}
+
+		void ChunkedLevelGenerator::generate(uint32_t width, uint32_t height)
+		{
+			this->width = width;
+			this->height = height;
+			this->tiles.assign(width * height, Tile::FREE);
+			this->nodes.clear();
+
+			uint32_t chunksX = (width + chunkSize - 1) / chunkSize;
+			uint32_t chunksY = (height + chunkSize - 1) / chunkSize;
+			// Chunks only write their own tiles, so they need no synchronization
+			std::vector<Scratch> scratches(this->threadPool.getThreadCount());
+			this->threadPool.parallelFor(chunksX * chunksY, 1, [this, chunksX, &scratches](uint32_t begin, uint32_t end, uint32_t thread)
+			{
+				for (uint32_t chunk = begin; chunk < end; ++chunk)
+				{
+					generateChunk(chunk % chunksX, chunk / chunksX, scratches[thread]);
+				}
+			});
+		}
+
+		void ChunkedLevelGenerator::createEntities(EntityManager& entityManager, std::vector<uint32_t>& created, float tileSize)
+		{
+			uint32_t count = this->width * this->height;
+			this->nodes.resize(count);
+			for (auto& node : this->nodes)
+			{
+				node = entityManager.createEntity();
+			}
+
+			// Node components are built in parallel, only adding them to the manager is sequential
+			std::vector<GridNodeComponent> components(count);
+			this->threadPool.parallelFor(this->height, 16, [this, &components](uint32_t begin, uint32_t end, uint32_t)
+			{
+				// Offsets of the neighbours in the order of the Direction enum, up is towards bigger y
+				static const int32_t offsets[][2] = {
+					{ 0, 1 }, { 0, -1 }, { -1, 0 }, { 1, 0 }, { -1, 1 }, { 1, 1 }, { -1, -1 }, { 1, -1 }
+				};
+
+				for (uint32_t y = begin; y < end; ++y)
+				{
+					for (uint32_t x = 0; x < this->width; ++x)
+					{
+						auto& component = components[y * this->width + x];
+						component.x = x;
+						component.y = y;
+						component.free = isPassable(this->tiles[y * this->width + x]);
+						for (uint32_t direction = Direction::UP; direction < Direction::PORTAL; ++direction)
+						{
+							int32_t nx = (int32_t)x + offsets[direction][0];
+							int32_t ny = (int32_t)y + offsets[direction][1];
+							if (nx >= 0 && ny >= 0 && nx < (int32_t)this->width && ny < (int32_t)this->height)
+							{
+								component.neighbours[direction] = this->nodes[ny * this->width + nx];
+							}
+						}
+					}
+				}
+			});
+
+			uint32_t unpairedPortal = uint32_t(-1);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				Vec2 position{ (i % this->width) * tileSize, (i / this->width) * tileSize };
+				if (this->tiles[i] == Tile::GOLD_MINE)
+				{
+					uint32_t mine = entityManager.createEntity();
+					entityManager.addComponent<MineComponent>(mine, MineComponent{});
+					entityManager.addComponent<GoldComponent>(mine, GoldComponent{ this->settings.goldPerMine, this->settings.goldPerMine });
+					entityManager.addComponent<PhysicsComponent>(mine, PhysicsComponent{ true, position });
+					components[i].resident = mine;
+					created.push_back(mine);
+				}
+				else if (this->tiles[i] == Tile::PORTAL)
+				{
+					uint32_t portal = entityManager.createEntity();
+					entityManager.addComponent<PortalComponent>(portal, PortalComponent{});
+					entityManager.addComponent<PhysicsComponent>(portal, PhysicsComponent{ false, position });
+					created.push_back(portal);
+
+					// Portals are linked in pairs in the order they appear in the map
+					if (unpairedPortal == uint32_t(-1))
+					{
+						unpairedPortal = i;
+					}
+					else
+					{
+						components[i].neighbours[Direction::PORTAL] = this->nodes[unpairedPortal];
+						components[unpairedPortal].neighbours[Direction::PORTAL] = this->nodes[i];
+						unpairedPortal = uint32_t(-1);
+					}
+				}
+			}
+
+			auto& container = entityManager.getComponentContainer<GridNodeComponent>();
+			container.reserve(container.size() + count);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				entityManager.addComponent<GridNodeComponent>(this->nodes[i], components[i]);
+			}
+			created.insert(created.end(), this->nodes.begin(), this->nodes.end());
+		}
+
+		uint32_t ChunkedLevelGenerator::getWidth() const
+		{
+			return this->width;
+		}
+
+		uint32_t ChunkedLevelGenerator::getHeight() const
+		{
+			return this->height;
+		}
+
+		Tile ChunkedLevelGenerator::getTile(uint32_t x, uint32_t y) const
+		{
+			RioAssert(x < this->width && y < this->height, "Tile out of the map");
+			return this->tiles[y * this->width + x];
+		}
+
+		const std::vector<Tile>& ChunkedLevelGenerator::getTiles() const
+		{
+			return this->tiles;
+		}
+
+		uint32_t ChunkedLevelGenerator::getNode(uint32_t x, uint32_t y) const
+		{
+			RioAssert(x < this->width && y < this->height && !this->nodes.empty(), "Node out of the map");
+			return this->nodes[y * this->width + x];
+		}
+
+		void ChunkedLevelGenerator::generateChunk(uint32_t chunkX, uint32_t chunkY, Scratch& scratch)
+		{
+			uint32_t left = chunkX * chunkSize;
+			uint32_t top = chunkY * chunkSize;
+			uint32_t chunkWidth = std::min(chunkSize, this->width - left);
+			uint32_t chunkHeight = std::min(chunkSize, this->height - top);
+			// Chunks in the same row (column) have the same height (width), so their corridors line up
+			uint32_t corridorX = left + chunkWidth / 2;
+			uint32_t corridorY = top + chunkHeight / 2;
+			auto at = [this](uint32_t x, uint32_t y) -> Tile& { return this->tiles[y * this->width + x]; };
+
+			// Noise
+			for (uint32_t y = top; y < top + chunkHeight; ++y)
+			{
+				for (uint32_t x = left; x < left + chunkWidth; ++x)
+				{
+					bool corridor = x == corridorX || y == corridorY;
+					at(x, y) = !corridor && getNoise(x, y) > this->settings.wallThreshold ? Tile::WALL : Tile::FREE;
+				}
+			}
+
+			// Features
+			ChunkRandom random{ hashPosition(this->settings.seed, chunkX, chunkY, 0xfea7) };
+			auto placeFeature = [&](Tile feature)
+			{
+				// A few attempts to find a free tile off the corridors
+				for (uint32_t attempt = 0; attempt < 16; ++attempt)
+				{
+					uint32_t x = left + random.next(chunkWidth);
+					uint32_t y = top + random.next(chunkHeight);
+					if (at(x, y) == Tile::FREE && x != corridorX && y != corridorY)
+					{
+						at(x, y) = feature;
+						return;
+					}
+				}
+			};
+			for (uint32_t i = 0; i < this->settings.minesPerChunk; ++i)
+			{
+				placeFeature(Tile::GOLD_MINE);
+			}
+			if (random.nextFloat() < this->settings.portalChance)
+			{
+				placeFeature(Tile::PORTAL);
+			}
+
+			// Connectivity, flood fill from the corridors (mines block the way)
+			auto& reached = scratch.reached;
+			auto& stack = scratch.stack;
+			reached.assign(chunkWidth * chunkHeight, 0);
+			stack.clear();
+			auto visit = [&](uint32_t x, uint32_t y)
+			{
+				uint32_t local = (y - top) * chunkWidth + (x - left);
+				if (!reached[local] && isPassable(at(x, y)))
+				{
+					reached[local] = 1;
+					stack.push_back(local);
+				}
+			};
+			for (uint32_t x = left; x < left + chunkWidth; ++x)
+			{
+				visit(x, corridorY);
+			}
+			for (uint32_t y = top; y < top + chunkHeight; ++y)
+			{
+				visit(corridorX, y);
+			}
+			while (!stack.empty())
+			{
+				uint32_t local = stack.back();
+				stack.pop_back();
+				uint32_t x = left + local % chunkWidth;
+				uint32_t y = top + local / chunkWidth;
+				if (x > left) visit(x - 1, y);
+				if (x + 1 < left + chunkWidth) visit(x + 1, y);
+				if (y > top) visit(x, y - 1);
+				if (y + 1 < top + chunkHeight) visit(x, y + 1);
+			}
+
+			// Unreachable tiles become walls, so do mines that can't be reached from any side
+			for (uint32_t y = top; y < top + chunkHeight; ++y)
+			{
+				for (uint32_t x = left; x < left + chunkWidth; ++x)
+				{
+					uint32_t local = (y - top) * chunkWidth + (x - left);
+					Tile& tile = at(x, y);
+					if (isPassable(tile) && !reached[local])
+					{
+						tile = Tile::WALL;
+					}
+					else if (tile == Tile::GOLD_MINE)
+					{
+						bool accessible = (x > left && reached[local - 1])
+							|| (x + 1 < left + chunkWidth && reached[local + 1])
+							|| (y > top && reached[local - chunkWidth])
+							|| (y + 1 < top + chunkHeight && reached[local + chunkWidth]);
+						if (!accessible)
+						{
+							tile = Tile::WALL;
+						}
+					}
+				}
+			}
+		}
+
+		float ChunkedLevelGenerator::getNoise(uint32_t x, uint32_t y) const
+		{
+			float cellSize = this->settings.noiseCellSize;
+			return 0.65f * valueNoise(this->settings.seed, 1, x, y, cellSize)
+				+ 0.35f * valueNoise(this->settings.seed, 2, x, y, cellSize * 0.5f);
+		}
+
+	} // namespace LevelGenerators
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,89 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace RioGame
+{
+
+	class EntityManager;
+	class ThreadPool;
+
+	namespace LevelGenerators
+	{
+
+		enum class Tile : uint8_t
+		{
+			FREE = 0,
+			WALL,
+			GOLD_MINE,
+			PORTAL
+		};
+
+		struct LevelSettings
+		{
+			uint32_t seed = 0;
+			// Tiles with noise above the threshold become walls
+			float wallThreshold = 0.62f;
+			// Size (in tiles) of the coarsest noise octave
+			float noiseCellSize = 24.0f;
+			uint32_t minesPerChunk = 2;
+			uint32_t goldPerMine = 5000;
+			// Chance of a chunk getting a portal, portals are linked in pairs
+			float portalChance = 0.25f;
+		};
+
+		// Level generator splitting the map into chunkSize x chunkSize chunks that are generated in parallel
+		// Every chunk runs noise (walls), feature placement (gold mines and portals) and a connectivity check
+		// on its own, features of a chunk only depend on the seed and the chunk's position, so the result
+		// doesn't depend on the amount of threads. Corridors through the middle row and column of every chunk
+		// connect it to its neighbours, free tiles the flood fill from the corridors doesn't reach become walls
+		class ChunkedLevelGenerator
+		{
+		public:
+			static constexpr uint32_t chunkSize = 64;
+
+			ChunkedLevelGenerator(ThreadPool& threadPool, const LevelSettings& settings = LevelSettings{});
+
+			void setSettings(const LevelSettings& settings);
+			const LevelSettings& getSettings() const;
+
+			// Generates the tiles of a width x height map
+			void generate(uint32_t width, uint32_t height);
+			// Creates the grid node entities of the generated map (neighbours linked, walls and mines not free)
+			// and the entities of gold mines and portals, tileSize is the distance of two nodes in the world
+			// Only the node components are built in parallel, the EntityManager isn't thread safe, so
+			// creating the entities and adding their components is sequential
+			// The ids of all created entities are appended to created (see World::createLevel)
+			void createEntities(EntityManager& entityManager, std::vector<uint32_t>& created, float tileSize = 1.0f);
+
+			uint32_t getWidth() const;
+			uint32_t getHeight() const;
+			Tile getTile(uint32_t x, uint32_t y) const;
+			const std::vector<Tile>& getTiles() const;
+			// Returns the grid node entity at the position, valid after createEntities
+			uint32_t getNode(uint32_t x, uint32_t y) const;
+		private:
+			// Flood fill data of a thread, reused by all chunks it generates
+			struct Scratch
+			{
+				std::vector<uint32_t> stack;
+				std::vector<uint8_t> reached;
+			};
+
+			void generateChunk(uint32_t chunkX, uint32_t chunkY, Scratch& scratch);
+			float getNoise(uint32_t x, uint32_t y) const;
+
+			ThreadPool& threadPool;
+			LevelSettings settings;
+			uint32_t width = 0;
+			uint32_t height = 0;
+			std::vector<Tile> tiles;
+			std::vector<uint32_t> nodes;
+		};
+
+	} // namespace LevelGenerators
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,132 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "ProjectileSystem.h"
+
+#include <algorithm>
+
+#include "2d/CCSprite.h"
+
+#include "Components.h"
+#include "EntityManager.h"
+#include "World/World.h"
+
+namespace RioGame
+{
+
+	ProjectileSystem::ProjectileSystem(World& world, EntityManager& entityManager, uint32_t capacity)
+		: world(world)
+		, entityManager(entityManager)
+		, pool{ capacity }
+	{
+		this->impacts.reserve(capacity);
+	}
+
+	bool ProjectileSystem::fire(uint32_t source, uint32_t target, uint32_t dmg)
+	{
+		auto sourcePhysics = this->entityManager.getComponent<PhysicsComponent>(source);
+		auto targetPhysics = this->entityManager.getComponent<PhysicsComponent>(target);
+		if (sourcePhysics == nullptr || targetPhysics == nullptr)
+		{
+			return false;
+		}
+
+		if (!this->pool.spawn(sourcePhysics->position, targetPhysics->position, source, target, dmg, this->speed))
+		{
+			return false;
+		}
+
+		uint32_t index = this->pool.getActiveCount() - 1;
+		Node* node = this->pool.getNode(index);
+		if (node == nullptr && this->layer != nullptr)
+		{
+			// Batched with the other sprites of its atlas page when the sprite is in an atlas
+			node = this->world.getSpriteAtlas().createSprite(this->sprite, this->layer);
+			this->pool.setNode(index, node);
+		}
+
+		if (node != nullptr)
+		{
+			node->setPosition(sourcePhysics->position);
+			node->setVisible(true);
+		}
+		return true;
+	}
+
+	void ProjectileSystem::process()
+	{
+		for (uint32_t i = 0; i < this->pool.getActiveCount(); ++i)
+		{
+			uint32_t target = this->pool.getTarget(i);
+			if (target == Component::NO_ENTITY)
+			{
+				continue;
+			}
+
+			auto physics = this->entityManager.getComponent<PhysicsComponent>(target);
+			if (physics != nullptr)
+			{
+				this->pool.setTargetPosition(i, physics->position);
+			}
+			else
+			{
+				this->pool.loseTarget(i);
+			}
+		}
+
+		this->impacts.clear();
+		this->pool.step(this->world.getDelta(), this->hitRadius, this->impacts);
+
+		for (const auto& impact : this->impacts)
+		{
+			applyDamage(impact);
+		}
+
+		for (uint32_t i = 0; i < this->pool.getActiveCount(); ++i)
+		{
+			Node* node = this->pool.getNode(i);
+			if (node != nullptr)
+			{
+				node->setPosition(this->pool.getPosition(i));
+			}
+		}
+	}
+
+	void ProjectileSystem::setLayer(Node* layer)
+	{
+		this->layer = layer;
+	}
+
+	void ProjectileSystem::setSprite(const std::string& sprite)
+	{
+		this->sprite = sprite;
+	}
+
+	void ProjectileSystem::setSpeed(float speed)
+	{
+		this->speed = speed;
+	}
+
+	void ProjectileSystem::clear()
+	{
+		this->pool.clear();
+	}
+
+	ProjectilePool& ProjectileSystem::getPool()
+	{
+		return this->pool;
+	}
+
+	void ProjectileSystem::applyDamage(const ProjectilePool::Impact& impact)
+	{
+		auto health = this->entityManager.getComponent<HealthComponent>(impact.target);
+		if (health == nullptr || !health->alive)
+		{
+			return;
+		}
+
+		uint32_t damage = impact.dmg > health->defense ? impact.dmg - health->defense : 0;
+		health->currentHealthPoints -= std::min(damage, health->currentHealthPoints);
+		this->world.getChangeTracker().markChanged<HealthComponent>(impact.target);
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,56 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "World/ProjectilePool.h"
+
+namespace RioGame
+{
+
+	class World;
+	class EntityManager;
+
+	// Handles ranged attack projectiles without creating entities for them,
+	// projectiles live in a ProjectilePool and their slots (including sprites) get recycled
+	class ProjectileSystem
+	{
+	public:
+		ProjectileSystem(World& world, EntityManager& entityManager, uint32_t capacity = 4096);
+		ProjectileSystem(const ProjectileSystem&) = delete;
+		ProjectileSystem& operator=(const ProjectileSystem&) = delete;
+
+		// Fires a projectile from the source entity at the target entity
+		// Returns false if either of them has no PhysicsComponent or the pool is exhausted
+		bool fire(uint32_t source, uint32_t target, uint32_t dmg);
+		// Updates target positions, moves all projectiles and applies damage on impact
+		void process();
+		// Sets the node that projectile sprites are attached to
+		void setLayer(Node* layer);
+		// Sets the sprite used for newly created projectile nodes
+		void setSprite(const std::string& sprite);
+		// Sets the speed of projectiles fired from now on
+		void setSpeed(float speed);
+		// Removes all flying projectiles
+		void clear();
+
+		ProjectilePool& getPool();
+	private:
+		// Subtracts the impact's damage (reduced by the target's defense) from the target's health
+		void applyDamage(const ProjectilePool::Impact& impact);
+
+		World& world;
+		EntityManager& entityManager;
+		ProjectilePool pool;
+		// Reused every frame to avoid reallocation
+		std::vector<ProjectilePool::Impact> impacts;
+		Node* layer = nullptr;
+		std::string sprite = "projectile.png";
+		float speed = 12.0f;
+		float hitRadius = 0.25f;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,224 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "AtlasPacker.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "platform/CCImage.h"
+
+#include "BlueprintPipeline.h"
+
+namespace RioGame
+{
+
+	using ::RioEngine::Image;
+
+	namespace
+	{
+		uint32_t nextPowerOfTwo(uint32_t value)
+		{
+			uint32_t result = 1;
+			while (result < value)
+			{
+				result <<= 1;
+			}
+			return result;
+		}
+
+		std::string getFileName(const std::string& path)
+		{
+			size_t slash = path.find_last_of("/\\");
+			return slash != std::string::npos ? path.substr(slash + 1) : path;
+		}
+
+		void writePlist(const std::string& path, const std::string& texture
+			, uint32_t width, uint32_t height, const std::vector<const AtlasRect*>& rects)
+		{
+			std::ofstream file{ path };
+			if (!file)
+			{
+				throw std::runtime_error{ "Could not write atlas plist " + path };
+			}
+
+			file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+				<< "<!DOCTYPE plist PUBLIC \"-//Apple//DTD PLIST 1.0//EN\" \"http://www.apple.com/DTDs/PropertyList-1.0.dtd\">\n"
+				<< "<plist version=\"1.0\">\n<dict>\n\t<key>frames</key>\n\t<dict>\n";
+			for (auto rect : rects)
+			{
+				std::string size = "{" + std::to_string(rect->width) + "," + std::to_string(rect->height) + "}";
+				file << "\t\t<key>" << rect->name << "</key>\n\t\t<dict>\n"
+					<< "\t\t\t<key>frame</key>\n\t\t\t<string>{{" << rect->x << "," << rect->y << "}," << size << "}</string>\n"
+					<< "\t\t\t<key>offset</key>\n\t\t\t<string>{0,0}</string>\n"
+					<< "\t\t\t<key>rotated</key>\n\t\t\t<false/>\n"
+					<< "\t\t\t<key>sourceColorRect</key>\n\t\t\t<string>{{0,0}," << size << "}</string>\n"
+					<< "\t\t\t<key>sourceSize</key>\n\t\t\t<string>" << size << "</string>\n"
+					<< "\t\t</dict>\n";
+			}
+			file << "\t</dict>\n\t<key>metadata</key>\n\t<dict>\n"
+				<< "\t\t<key>format</key>\n\t\t<integer>2</integer>\n"
+				<< "\t\t<key>size</key>\n\t\t<string>{" << width << "," << height << "}</string>\n"
+				<< "\t\t<key>textureFileName</key>\n\t\t<string>" << texture << "</string>\n"
+				<< "\t</dict>\n</dict>\n</plist>\n";
+		}
+	}
+
+	AtlasPacker::AtlasPacker(uint32_t maxPageSize, uint32_t padding)
+		: maxPageSize{ maxPageSize }
+		, padding{ padding }
+	{
+	}
+
+	void AtlasPacker::addSprite(const std::string& name, uint32_t width, uint32_t height)
+	{
+		this->rects.push_back(AtlasRect{ name, 0, 0, 0, width, height });
+	}
+
+	void AtlasPacker::pack()
+	{
+		std::sort(this->rects.begin(), this->rects.end(), [](const AtlasRect& lhs, const AtlasRect& rhs)
+		{
+			return lhs.height != rhs.height ? lhs.height > rhs.height : lhs.name < rhs.name;
+		});
+
+		this->pages.clear();
+		uint32_t page = 0;
+		uint32_t shelfY = 0;
+		uint32_t shelfHeight = 0;
+		uint32_t x = 0;
+		uint32_t usedWidth = 0;
+		auto closePage = [&]()
+		{
+			this->pages.push_back(PageSize{ nextPowerOfTwo(usedWidth), nextPowerOfTwo(shelfY + shelfHeight) });
+		};
+
+		for (auto& rect : this->rects)
+		{
+			uint32_t width = rect.width + this->padding;
+			uint32_t height = rect.height + this->padding;
+			if (width > this->maxPageSize || height > this->maxPageSize)
+			{
+				throw std::runtime_error{ "Sprite " + rect.name + " is bigger than an atlas page" };
+			}
+
+			if (x + width > this->maxPageSize)
+			{
+				// Next shelf
+				shelfY += shelfHeight;
+				shelfHeight = 0;
+				x = 0;
+			}
+			if (shelfY + height > this->maxPageSize)
+			{
+				closePage();
+				++page;
+				shelfY = 0;
+				shelfHeight = 0;
+				x = 0;
+				usedWidth = 0;
+			}
+
+			rect.page = page;
+			rect.x = x;
+			rect.y = shelfY;
+			x += width;
+			usedWidth = std::max(usedWidth, x);
+			shelfHeight = std::max(shelfHeight, height);
+		}
+		if (!this->rects.empty())
+		{
+			closePage();
+		}
+	}
+
+	const std::vector<AtlasRect>& AtlasPacker::getRects() const
+	{
+		return this->rects;
+	}
+
+	uint32_t AtlasPacker::getPageCount() const
+	{
+		return (uint32_t)this->pages.size();
+	}
+
+	uint32_t AtlasPacker::getPageWidth(uint32_t page) const
+	{
+		return this->pages[page].width;
+	}
+
+	uint32_t AtlasPacker::getPageHeight(uint32_t page) const
+	{
+		return this->pages[page].height;
+	}
+
+	void AtlasPacker::write(const std::string& spriteDirectory, const std::string& outputPrefix) const
+	{
+		std::ofstream index{ outputPrefix + ".index" };
+		if (!index)
+		{
+			throw std::runtime_error{ "Could not write atlas index " + outputPrefix + ".index" };
+		}
+
+		for (uint32_t page = 0; page < this->pages.size(); ++page)
+		{
+			uint32_t pageWidth = this->pages[page].width;
+			uint32_t pageHeight = this->pages[page].height;
+			std::vector<unsigned char> pixels(pageWidth * pageHeight * 4, 0);
+			std::vector<const AtlasRect*> pageRects;
+
+			for (const auto& rect : this->rects)
+			{
+				if (rect.page != page)
+				{
+					continue;
+				}
+				pageRects.push_back(&rect);
+
+				Image image;
+				std::string path = spriteDirectory + "/" + rect.name;
+				if (!image.initWithImageFile(path) || image.getBitPerPixel() != 32
+					|| (uint32_t)image.getWidth() != rect.width || (uint32_t)image.getHeight() != rect.height)
+				{
+					throw std::runtime_error{ "Could not read RGBA8888 sprite " + path };
+				}
+				for (uint32_t row = 0; row < rect.height; ++row)
+				{
+					std::memcpy(&pixels[((rect.y + row) * pageWidth + rect.x) * 4]
+						, image.getData() + row * rect.width * 4, rect.width * 4);
+				}
+			}
+
+			std::string name = outputPrefix + std::to_string(page);
+			Image output;
+			if (!output.initWithRawData(pixels.data(), (long)pixels.size(), pageWidth, pageHeight, 8)
+				|| !output.saveToFile(name + ".png", false))
+			{
+				throw std::runtime_error{ "Could not write atlas page " + name + ".png" };
+			}
+			writePlist(name + ".plist", getFileName(name + ".png"), pageWidth, pageHeight, pageRects);
+			index << "page " << getFileName(name + ".plist") << " " << getFileName(name + ".png") << "\n";
+		}
+
+		for (const auto& rect : this->rects)
+		{
+			index << "sprite " << rect.name << " " << rect.page << "\n";
+		}
+	}
+
+	void AtlasPacker::collectSprites(const BlueprintData& blueprint, std::vector<std::string>& sprites)
+	{
+		static const std::string suffix = "sprite";
+		for (const auto& property : blueprint.properties)
+		{
+			const std::string& key = property.first;
+			if (key.size() >= suffix.size() && key.compare(key.size() - suffix.size(), suffix.size(), suffix) == 0
+				&& std::find(sprites.begin(), sprites.end(), property.second) == sprites.end())
+			{
+				sprites.push_back(property.second);
+			}
+		}
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,64 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace RioGame
+{
+
+	struct BlueprintData;
+
+	// Place of a sprite in an atlas page
+	struct AtlasRect
+	{
+		std::string name;
+		uint32_t page;
+		uint32_t x;
+		uint32_t y;
+		uint32_t width;
+		uint32_t height;
+	};
+
+	// Offline packer of sprite images into atlas pages (build step, see AtlasPackerMain.cpp)
+	// Sprites are sorted by height and put on shelves, every page gets a png, a sprite sheet plist
+	// (format 2, loadable by the SpriteFrameCache) and the output gets an index the SpriteAtlas loads at run time:
+	//
+	// page <plist> <png>
+	// sprite <name> <page>
+	class AtlasPacker
+	{
+	public:
+		AtlasPacker(uint32_t maxPageSize = 2048, uint32_t padding = 2);
+
+		void addSprite(const std::string& name, uint32_t width, uint32_t height);
+		// Places all added sprites, throws std::runtime_error if a sprite doesn't fit into a page
+		void pack();
+
+		const std::vector<AtlasRect>& getRects() const;
+		uint32_t getPageCount() const;
+		uint32_t getPageWidth(uint32_t page) const;
+		uint32_t getPageHeight(uint32_t page) const;
+
+		// Writes <outputPrefix><page>.png and .plist for every page and <outputPrefix>.index,
+		// sprite images are read from spriteDirectory (RGBA8888), throws std::runtime_error on failure
+		void write(const std::string& spriteDirectory, const std::string& outputPrefix) const;
+
+		// Appends the sprite names a blueprint references (values of properties whose key ends with "sprite")
+		static void collectSprites(const BlueprintData& blueprint, std::vector<std::string>& sprites);
+	private:
+		struct PageSize
+		{
+			uint32_t width;
+			uint32_t height;
+		};
+
+		uint32_t maxPageSize;
+		uint32_t padding;
+		std::vector<AtlasRect> rects;
+		std::vector<PageSize> pages;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,74 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+// Entry point of the offline atlas packer, only built by the atlas packer target (defines RIO_ATLAS_PACKER_TOOL)
+// Usage: AtlasPacker <sprite directory> <output prefix> <blueprint files...>
+#if RIO_ATLAS_PACKER_TOOL
+
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "platform/CCImage.h"
+
+#include "AtlasPacker.h"
+#include "BlueprintPipeline.h"
+
+int main(int argc, char** argv)
+{
+	using namespace RioGame;
+
+	if (argc < 4)
+	{
+		std::cerr << "Usage: AtlasPacker <sprite directory> <output prefix> <blueprint files...>" << std::endl;
+		return 1;
+	}
+
+	try
+	{
+		std::string spriteDirectory = argv[1];
+		std::vector<std::string> sprites;
+		for (int i = 3; i < argc; ++i)
+		{
+			std::ifstream file{ argv[i] };
+			if (!file)
+			{
+				throw std::runtime_error{ std::string{ "Could not open blueprint file " } + argv[i] };
+			}
+			std::stringstream source;
+			source << file.rdbuf();
+
+			std::vector<BlueprintData> blueprints;
+			BlueprintPipeline::parse(source.str(), argv[i], blueprints);
+			for (const auto& blueprint : blueprints)
+			{
+				AtlasPacker::collectSprites(blueprint, sprites);
+			}
+		}
+
+		AtlasPacker packer;
+		for (const auto& sprite : sprites)
+		{
+			::RioEngine::Image image;
+			if (!image.initWithImageFile(spriteDirectory + "/" + sprite))
+			{
+				throw std::runtime_error{ "Could not read sprite " + sprite };
+			}
+			packer.addSprite(sprite, image.getWidth(), image.getHeight());
+		}
+		packer.pack();
+		packer.write(spriteDirectory, argv[2]);
+
+		std::cout << "Packed " << sprites.size() << " sprites into " << packer.getPageCount() << " pages" << std::endl;
+	}
+	catch (const std::exception& ex)
+	{
+		std::cerr << ex.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+#endif // RIO_ATLAS_PACKER_TOOL
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
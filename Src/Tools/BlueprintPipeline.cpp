@@ -0,0 +1,565 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "BlueprintPipeline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace RioGame
+{
+
+	namespace
+	{
+		// "RBPC", bumped version invalidates all caches
+		constexpr uint32_t cacheMagic = 0x43504252;
+		constexpr uint32_t cacheVersion = 1;
+
+		[[noreturn]] void fail(const std::string& sourceName, uint32_t line, const std::string& message)
+		{
+			throw std::runtime_error{ sourceName + ":" + std::to_string(line) + ": " + message };
+		}
+
+		bool readFile(const std::string& path, std::string& content)
+		{
+			std::ifstream file{ path, std::ios::binary };
+			if (!file)
+			{
+				return false;
+			}
+
+			std::stringstream buffer;
+			buffer << file.rdbuf();
+			content = buffer.str();
+			return true;
+		}
+
+		std::string trim(const std::string& text)
+		{
+			size_t first = text.find_first_not_of(" \t\r");
+			if (first == std::string::npos)
+			{
+				return "";
+			}
+			size_t last = text.find_last_not_of(" \t\r");
+			return text.substr(first, last - first + 1);
+		}
+
+		// Little endian binary writer/reader of the cache files
+		class CacheWriter
+		{
+		public:
+			void write(uint32_t value)
+			{
+				for (uint32_t i = 0; i < 4; ++i)
+				{
+					this->data.push_back((char)((value >> (i * 8)) & 0xff));
+				}
+			}
+
+			void write(uint64_t value)
+			{
+				write((uint32_t)value);
+				write((uint32_t)(value >> 32));
+			}
+
+			void write(const std::string& value)
+			{
+				write((uint32_t)value.size());
+				this->data.append(value);
+			}
+
+			const std::string& getData() const
+			{
+				return this->data;
+			}
+		private:
+			std::string data;
+		};
+
+		class CacheReader
+		{
+		public:
+			CacheReader(const std::string& data)
+				: data{ data }
+			{
+			}
+
+			bool read(uint32_t& value)
+			{
+				if (this->data.size() - this->position < 4)
+				{
+					return false;
+				}
+				value = 0;
+				for (uint32_t i = 0; i < 4; ++i)
+				{
+					value |= (uint32_t)(uint8_t)this->data[this->position++] << (i * 8);
+				}
+				return true;
+			}
+
+			bool read(uint64_t& value)
+			{
+				uint32_t low, high;
+				if (!read(low) || !read(high))
+				{
+					return false;
+				}
+				value = ((uint64_t)high << 32) | low;
+				return true;
+			}
+
+			bool read(std::string& value)
+			{
+				uint32_t size;
+				if (!read(size) || this->data.size() - this->position < size)
+				{
+					return false;
+				}
+				value.assign(this->data, this->position, size);
+				this->position += size;
+				return true;
+			}
+
+			bool atEnd() const
+			{
+				return this->position == this->data.size();
+			}
+		private:
+			const std::string& data;
+			size_t position = 0;
+		};
+	}
+
+	const std::string* BlueprintData::find(const std::string& key) const
+	{
+		for (const auto& property : this->properties)
+		{
+			if (property.first == key)
+			{
+				return &property.second;
+			}
+		}
+		return nullptr;
+	}
+
+	float BlueprintData::getFloat(const std::string& key, float fallback) const
+	{
+		const std::string* value = find(key);
+		return value != nullptr ? std::strtof(value->c_str(), nullptr) : fallback;
+	}
+
+	BlueprintPipeline::BlueprintPipeline(const std::string& cacheDirectory)
+		: cacheDirectory{ cacheDirectory }
+	{
+	}
+
+	BlueprintPipeline::~BlueprintPipeline()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ this->filesMutex };
+			this->stopping = true;
+		}
+		this->wakeUp.notify_all();
+
+		if (this->worker.joinable())
+		{
+			this->worker.join();
+		}
+	}
+
+	void BlueprintPipeline::setChangeHandler(const ChangeHandler& handler)
+	{
+		this->changeHandler = handler;
+	}
+
+	void BlueprintPipeline::setRemoveHandler(const RemoveHandler& handler)
+	{
+		this->removeHandler = handler;
+	}
+
+	void BlueprintPipeline::setErrorHandler(const ErrorHandler& handler)
+	{
+		this->errorHandler = handler;
+	}
+
+	void BlueprintPipeline::addFile(const std::string& path)
+	{
+		{
+			std::lock_guard<std::mutex> lock{ this->filesMutex };
+			bool known = std::any_of(this->files.begin(), this->files.end(), [&path](const WatchedFile& file) {
+				return file.path == path;
+			});
+			if (known)
+			{
+				return;
+			}
+
+			this->files.push_back(WatchedFile{ path, 0, 0, false });
+			++this->unloadedCount;
+			startWorker();
+		}
+		this->wakeUp.notify_all();
+	}
+
+	void BlueprintPipeline::waitForLoads()
+	{
+		{
+			std::unique_lock<std::mutex> lock{ this->filesMutex };
+			this->loadsDone.wait(lock, [this]() { return this->unloadedCount == 0; });
+		}
+		process();
+	}
+
+	void BlueprintPipeline::startWatching(uint32_t intervalMs)
+	{
+		{
+			std::lock_guard<std::mutex> lock{ this->filesMutex };
+			this->interval = intervalMs;
+			this->watching = true;
+			startWorker();
+		}
+		this->wakeUp.notify_all();
+	}
+
+	void BlueprintPipeline::stopWatching()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ this->filesMutex };
+			this->watching = false;
+		}
+		this->wakeUp.notify_all();
+	}
+
+	void BlueprintPipeline::process()
+	{
+		std::vector<Reload> finished;
+		{
+			std::lock_guard<std::mutex> lock{ this->reloadsMutex };
+			finished.swap(this->reloads);
+		}
+
+		for (auto& reload : finished)
+		{
+			if (!reload.error.empty())
+			{
+				// The old data stays in use until the file is fixed
+				if (this->errorHandler)
+				{
+					this->errorHandler(reload.error);
+				}
+				continue;
+			}
+			apply(reload.path, reload.blueprints);
+		}
+	}
+
+	const BlueprintData* BlueprintPipeline::get(const std::string& name) const
+	{
+		auto it = this->blueprints.find(name);
+		return it != this->blueprints.end() ? &it->second : nullptr;
+	}
+
+	uint64_t BlueprintPipeline::hash(const std::string& content)
+	{
+		uint64_t result = 14695981039346656037ull;
+		for (char c : content)
+		{
+			result ^= (uint8_t)c;
+			result *= 1099511628211ull;
+		}
+		return result;
+	}
+
+	void BlueprintPipeline::parse(const std::string& source, const std::string& sourceName, std::vector<BlueprintData>& result)
+	{
+		std::istringstream lines{ source };
+		std::string line;
+		uint32_t lineNumber = 0;
+		BlueprintData* current = nullptr;
+
+		while (std::getline(lines, line))
+		{
+			++lineNumber;
+			size_t comment = line.find('#');
+			if (comment != std::string::npos)
+			{
+				line.erase(comment);
+			}
+			line = trim(line);
+			if (line.empty())
+			{
+				continue;
+			}
+
+			size_t separator = line.find_first_of(" \t");
+			std::string key = line.substr(0, separator);
+			std::string value = separator != std::string::npos ? trim(line.substr(separator)) : "";
+
+			if (key == "blueprint")
+			{
+				if (value.empty())
+				{
+					fail(sourceName, lineNumber, "blueprint without a name");
+				}
+				result.emplace_back();
+				current = &result.back();
+				current->name = value;
+			}
+			else if (current == nullptr)
+			{
+				fail(sourceName, lineNumber, "property outside of a blueprint");
+			}
+			else if (value.empty())
+			{
+				fail(sourceName, lineNumber, "property " + key + " without a value");
+			}
+			else
+			{
+				current->properties.emplace_back(key, value);
+			}
+		}
+	}
+
+	std::string BlueprintPipeline::getCachePath(const std::string& path) const
+	{
+		if (this->cacheDirectory.empty())
+		{
+			return path + ".cache";
+		}
+
+		size_t slash = path.find_last_of("/\\");
+		std::string fileName = slash != std::string::npos ? path.substr(slash + 1) : path;
+		return this->cacheDirectory + "/" + fileName + ".cache";
+	}
+
+	bool BlueprintPipeline::readCache(const std::string& path, uint64_t contentHash, std::vector<BlueprintData>& result) const
+	{
+		std::string data;
+		if (!readFile(getCachePath(path), data))
+		{
+			return false;
+		}
+
+		CacheReader reader{ data };
+		uint32_t magic, version, blueprintCount;
+		uint64_t cachedHash;
+		if (!reader.read(magic) || magic != cacheMagic
+			|| !reader.read(version) || version != cacheVersion
+			|| !reader.read(cachedHash) || cachedHash != contentHash
+			|| !reader.read(blueprintCount))
+		{
+			return false;
+		}
+
+		std::vector<BlueprintData> loaded(blueprintCount);
+		for (auto& blueprint : loaded)
+		{
+			uint32_t propertyCount;
+			if (!reader.read(blueprint.name) || !reader.read(propertyCount))
+			{
+				return false;
+			}
+
+			for (uint32_t i = 0; i < propertyCount; ++i)
+			{
+				std::pair<std::string, std::string> property;
+				if (!reader.read(property.first) || !reader.read(property.second))
+				{
+					return false;
+				}
+				blueprint.properties.push_back(std::move(property));
+			}
+		}
+
+		if (!reader.atEnd())
+		{
+			return false;
+		}
+		result.insert(result.end(), std::make_move_iterator(loaded.begin()), std::make_move_iterator(loaded.end()));
+		return true;
+	}
+
+	void BlueprintPipeline::writeCache(const std::string& path, uint64_t contentHash, const std::vector<BlueprintData>& blueprints) const
+	{
+		CacheWriter writer;
+		writer.write(cacheMagic);
+		writer.write(cacheVersion);
+		writer.write(contentHash);
+		writer.write((uint32_t)blueprints.size());
+		for (const auto& blueprint : blueprints)
+		{
+			writer.write(blueprint.name);
+			writer.write((uint32_t)blueprint.properties.size());
+			for (const auto& property : blueprint.properties)
+			{
+				writer.write(property.first);
+				writer.write(property.second);
+			}
+		}
+
+		// A cache that can't be written only costs a parse on the next start
+		std::ofstream file{ getCachePath(path), std::ios::binary | std::ios::trunc };
+		file.write(writer.getData().data(), writer.getData().size());
+	}
+
+	void BlueprintPipeline::apply(const std::string& path, std::vector<BlueprintData>& loaded)
+	{
+		// Blueprints the file used to define and doesn't anymore are dropped
+		for (auto source = this->sources.begin(); source != this->sources.end();)
+		{
+			const std::string& name = source->first;
+			bool kept = source->second != path || std::any_of(loaded.begin(), loaded.end(), [&name](const BlueprintData& blueprint) {
+				return blueprint.name == name;
+			});
+			if (kept)
+			{
+				++source;
+				continue;
+			}
+
+			std::string removed = name;
+			this->blueprints.erase(removed);
+			source = this->sources.erase(source);
+			if (this->removeHandler)
+			{
+				this->removeHandler(removed);
+			}
+		}
+
+		for (auto& blueprint : loaded)
+		{
+			this->sources[blueprint.name] = path;
+			BlueprintData& stored = this->blueprints[blueprint.name];
+			stored = std::move(blueprint);
+			if (this->changeHandler)
+			{
+				this->changeHandler(stored);
+			}
+		}
+	}
+
+	bool BlueprintPipeline::load(WatchedFile& file, Reload& reload) const
+	{
+		reload.path = file.path;
+		std::string content;
+		if (!readFile(file.path, content))
+		{
+			if (file.loaded)
+			{
+				// Files in the middle of being saved are picked up on the next check
+				return false;
+			}
+
+			// Loaded once it shows up
+			file.loaded = true;
+			reload.error = "Could not open blueprint file " + file.path;
+			return true;
+		}
+
+		uint64_t contentHash = hash(content);
+		if (file.loaded && contentHash == file.hash)
+		{
+			return false;
+		}
+
+		// A file being saved might be read half written, a change is only taken once it stopped changing
+		if (file.loaded && contentHash != file.pendingHash)
+		{
+			file.pendingHash = contentHash;
+			return false;
+		}
+		file.hash = contentHash;
+		file.loaded = true;
+
+		try
+		{
+			if (!readCache(file.path, contentHash, reload.blueprints))
+			{
+				parse(content, file.path, reload.blueprints);
+				writeCache(file.path, contentHash, reload.blueprints);
+			}
+		}
+		catch (const std::exception& e)
+		{
+			reload.blueprints.clear();
+			reload.error = e.what();
+		}
+		return true;
+	}
+
+	void BlueprintPipeline::startWorker()
+	{
+		if (!this->worker.joinable())
+		{
+			this->worker = std::thread{ &BlueprintPipeline::work, this };
+		}
+	}
+
+	void BlueprintPipeline::work()
+	{
+		using Clock = std::chrono::steady_clock;
+		auto nextCheck = Clock::now();
+
+		std::unique_lock<std::mutex> lock{ this->filesMutex };
+		while (!this->stopping)
+		{
+			bool checkDue = this->watching && Clock::now() >= nextCheck;
+			if (this->unloadedCount == 0 && !checkDue)
+			{
+				if (this->watching)
+				{
+					this->wakeUp.wait_until(lock, nextCheck);
+				}
+				else
+				{
+					this->wakeUp.wait(lock);
+				}
+				continue;
+			}
+
+			if (checkDue)
+			{
+				nextCheck = Clock::now() + std::chrono::milliseconds(this->interval);
+			}
+
+			// Files added while this one is loading are picked up in the next round
+			std::vector<WatchedFile> snapshot = this->files;
+			lock.unlock();
+
+			uint32_t newlyLoaded = 0;
+			for (auto& file : snapshot)
+			{
+				if (file.loaded && !checkDue)
+				{
+					continue;
+				}
+
+				bool wasLoaded = file.loaded;
+				Reload reload;
+				if (load(file, reload))
+				{
+					std::lock_guard<std::mutex> reloadsLock{ this->reloadsMutex };
+					this->reloads.push_back(std::move(reload));
+				}
+				newlyLoaded += wasLoaded ? 0 : 1;
+			}
+
+			lock.lock();
+			// Only this thread changes the hashes
+			for (uint32_t i = 0; i < snapshot.size(); ++i)
+			{
+				this->files[i].hash = snapshot[i].hash;
+				this->files[i].pendingHash = snapshot[i].pendingHash;
+				this->files[i].loaded = snapshot[i].loaded;
+			}
+			this->unloadedCount -= newlyLoaded;
+			this->loadsDone.notify_all();
+		}
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,133 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace RioGame
+{
+
+	// Parsed data of a single blueprint, properties are kept in file order
+	struct BlueprintData
+	{
+		std::string name;
+		std::vector<std::pair<std::string, std::string>> properties;
+
+		// Returns the value of the property or nullptr if the blueprint doesn't set it
+		const std::string* find(const std::string& key) const;
+		float getFloat(const std::string& key, float fallback = 0.0f) const;
+	};
+
+	// Loads blueprint data files and keeps them up to date while the game runs
+	// Every blueprint starts with "blueprint <name>" followed by "<key> <value>" lines,
+	// the value is the rest of the line, '#' starts a comment:
+	//
+	// blueprint orc
+	//     HealthComponent.maxHealth 150
+	//     GraphicsComponent.sprite orc.png
+	//
+	// Parsed files are stored in a binary cache next to them, keyed by the hash of the file content,
+	// so a warm start only hashes the files. Files are loaded and re-hashed on a background thread,
+	// changed ones are parsed there as well and handed to the change handler by process() on the main thread
+	class BlueprintPipeline
+	{
+	public:
+		using ChangeHandler = std::function<void(const BlueprintData&)>;
+		using RemoveHandler = std::function<void(const std::string& name)>;
+		using ErrorHandler = std::function<void(const std::string&)>;
+
+		// The cache of a file is stored as <file>.cache, or in cacheDirectory if it isn't empty
+		BlueprintPipeline(const std::string& cacheDirectory = "");
+		BlueprintPipeline(const BlueprintPipeline&) = delete;
+		BlueprintPipeline& operator=(const BlueprintPipeline&) = delete;
+		// Stops the background thread
+		~BlueprintPipeline();
+
+		void setChangeHandler(const ChangeHandler& handler);
+		// Called for blueprints a reloaded file doesn't define anymore
+		void setRemoveHandler(const RemoveHandler& handler);
+		void setErrorHandler(const ErrorHandler& handler);
+
+		// Loads the file on the background thread (from the cache if it's up to date) and watches it from
+		// now on, a file that is already watched is not added again
+		// Its blueprints reach the change handler in process(), malformed data is reported to the error handler
+		void addFile(const std::string& path);
+		// Blocks until all added files are loaded and applies them (at the start of a level)
+		void waitForLoads();
+		// Starts re-checking the watched files every intervalMs milliseconds on the background thread
+		void startWatching(uint32_t intervalMs = 500);
+		void stopWatching();
+		// Applies the blueprints loaded or changed since the last call and reports failed loads, has to be called from the main thread
+		void process();
+
+		// Returns the current data of the blueprint or nullptr if no file defines it
+		const BlueprintData* get(const std::string& name) const;
+
+		// 64 bit FNV-1a hash of the content
+		static uint64_t hash(const std::string& content);
+		// Appends all blueprints of the source to result, throws std::runtime_error on malformed data
+		static void parse(const std::string& source, const std::string& sourceName, std::vector<BlueprintData>& result);
+	private:
+		struct WatchedFile
+		{
+			std::string path;
+			uint64_t hash;
+			// Hash of the changed content seen on the last check, reloaded once it's seen twice in a row
+			uint64_t pendingHash;
+			// False until the background thread loaded it for the first time
+			bool loaded;
+		};
+
+		// Result of a load or reload done by the background thread
+		struct Reload
+		{
+			std::string path;
+			std::vector<BlueprintData> blueprints;
+			std::string error;
+		};
+
+		std::string getCachePath(const std::string& path) const;
+		bool readCache(const std::string& path, uint64_t contentHash, std::vector<BlueprintData>& result) const;
+		void writeCache(const std::string& path, uint64_t contentHash, const std::vector<BlueprintData>& blueprints) const;
+		// Loads the file if it wasn't loaded yet or changed, returns false if there's nothing new
+		bool load(WatchedFile& file, Reload& reload) const;
+		void apply(const std::string& path, std::vector<BlueprintData>& blueprints);
+		// Has to be called with the files locked
+		void startWorker();
+		void work();
+
+		std::string cacheDirectory;
+		std::unordered_map<std::string, BlueprintData> blueprints;
+		// File each blueprint was loaded from
+		std::unordered_map<std::string, std::string> sources;
+		ChangeHandler changeHandler;
+		RemoveHandler removeHandler;
+		ErrorHandler errorHandler;
+
+		// Files are only appended, indices stay valid
+		std::vector<WatchedFile> files;
+		uint32_t unloadedCount = 0;
+		bool watching = false;
+		bool stopping = false;
+		uint32_t interval = 500;
+		std::mutex filesMutex;
+		// Signalled when a file is added, watching starts or stops
+		std::condition_variable wakeUp;
+		// Signalled when the background thread loaded files
+		std::condition_variable loadsDone;
+
+		std::vector<Reload> reloads;
+		std::mutex reloadsMutex;
+
+		std::thread worker;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,405 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+
+#include "SlabAllocator.h"
+
+namespace RioGame
+{
+
+	// Storage shared by the inline containers, the first N elements live inside the
+	// object itself, more elements move to a block from the SlabAllocator
+	// Only for trivially copyable elements, so that elements can be moved with memcpy
+	template<typename T, uint32_t N>
+	class InlineStorage
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Inline containers only hold trivially copyable types");
+		static_assert(N > 0, "Inline capacity has to be at least one");
+	public:
+		InlineStorage() = default;
+
+		InlineStorage(const InlineStorage& rhs)
+		{
+			copyFrom(rhs);
+		}
+
+		InlineStorage(InlineStorage&& rhs)
+		{
+			moveFrom(rhs);
+		}
+
+		InlineStorage& operator=(const InlineStorage& rhs)
+		{
+			if (this != &rhs)
+			{
+				release();
+				copyFrom(rhs);
+			}
+			return *this;
+		}
+
+		InlineStorage& operator=(InlineStorage&& rhs)
+		{
+			if (this != &rhs)
+			{
+				release();
+				moveFrom(rhs);
+			}
+			return *this;
+		}
+
+		~InlineStorage()
+		{
+			release();
+		}
+
+		uint32_t capacity() const
+		{
+			return this->capacity_;
+		}
+
+		bool isInline() const
+		{
+			return this->capacity_ == N;
+		}
+	protected:
+		T* elements()
+		{
+			return isInline() ? reinterpret_cast<T*>(this->inlineElements) : this->heap;
+		}
+
+		const T* elements() const
+		{
+			return isInline() ? reinterpret_cast<const T*>(this->inlineElements) : this->heap;
+		}
+
+		// Replaces the storage with a bigger one, elements [first, first + count) of the old storage
+		// (indices wrap around the old capacity) are copied to the start of the new storage
+		void grow(uint32_t newCapacity, uint32_t first, uint32_t count)
+		{
+			T* newElements = static_cast<T*>(SlabAllocator::getInstance().allocate(newCapacity * sizeof(T)));
+			const T* oldElements = elements();
+			uint32_t untilEnd = std::min(count, this->capacity_ - first);
+			std::memcpy(newElements, oldElements + first, untilEnd * sizeof(T));
+			std::memcpy(newElements + untilEnd, oldElements, (count - untilEnd) * sizeof(T));
+
+			release();
+			this->heap = newElements;
+			this->capacity_ = newCapacity;
+		}
+
+		uint32_t count_ = 0;
+		// Index of the first element (only used by InlineDeque)
+		uint32_t head = 0;
+	private:
+		void release()
+		{
+			if (!isInline())
+			{
+				SlabAllocator::getInstance().deallocate(this->heap, this->capacity_ * sizeof(T));
+				this->capacity_ = N;
+			}
+		}
+
+		void copyFrom(const InlineStorage& rhs)
+		{
+			if (!rhs.isInline())
+			{
+				this->heap = static_cast<T*>(SlabAllocator::getInstance().allocate(rhs.capacity_ * sizeof(T)));
+			}
+			this->capacity_ = rhs.capacity_;
+			std::memcpy(elements(), rhs.elements(), this->capacity_ * sizeof(T));
+			this->count_ = rhs.count_;
+			this->head = rhs.head;
+		}
+
+		void moveFrom(InlineStorage& rhs)
+		{
+			if (rhs.isInline())
+			{
+				std::memcpy(this->inlineElements, rhs.inlineElements, sizeof(this->inlineElements));
+			}
+			else
+			{
+				this->heap = rhs.heap;
+			}
+			this->capacity_ = rhs.capacity_;
+			this->count_ = rhs.count_;
+			this->head = rhs.head;
+
+			rhs.capacity_ = N;
+			rhs.count_ = 0;
+			rhs.head = 0;
+		}
+
+		union
+		{
+			alignas(T) unsigned char inlineElements[N * sizeof(T)];
+			T* heap;
+		};
+		uint32_t capacity_ = N;
+	};
+
+	// Vector with room for N elements inside the object
+	template<typename T, uint32_t N>
+	class InlineVector : public InlineStorage<T, N>
+	{
+	public:
+		using value_type = T;
+		using size_type = uint32_t;
+		using iterator = T*;
+		using const_iterator = const T*;
+
+		InlineVector() = default;
+
+		InlineVector(std::initializer_list<T> values)
+		{
+			for (const auto& value : values)
+			{
+				push_back(value);
+			}
+		}
+
+		T* data() { return this->elements(); }
+		const T* data() const { return this->elements(); }
+		iterator begin() { return data(); }
+		iterator end() { return data() + this->count_; }
+		const_iterator begin() const { return data(); }
+		const_iterator end() const { return data() + this->count_; }
+		uint32_t size() const { return this->count_; }
+		bool empty() const { return this->count_ == 0; }
+		T& operator[](uint32_t index) { return data()[index]; }
+		const T& operator[](uint32_t index) const { return data()[index]; }
+		T& front() { return data()[0]; }
+		T& back() { return data()[this->count_ - 1]; }
+		const T& front() const { return data()[0]; }
+		const T& back() const { return data()[this->count_ - 1]; }
+
+		void push_back(const T& value)
+		{
+			if (this->count_ == this->capacity())
+			{
+				this->grow(this->capacity() * 2, 0, this->count_);
+			}
+			data()[this->count_++] = value;
+		}
+
+		void pop_back()
+		{
+			--this->count_;
+		}
+
+		void clear()
+		{
+			this->count_ = 0;
+		}
+
+		void reserve(uint32_t newCapacity)
+		{
+			if (newCapacity > this->capacity())
+			{
+				this->grow(newCapacity, 0, this->count_);
+			}
+		}
+
+		void resize(uint32_t newSize, const T& value = T{})
+		{
+			reserve(newSize);
+			std::fill(data() + std::min(newSize, this->count_), data() + newSize, value);
+			this->count_ = newSize;
+		}
+
+		iterator erase(const_iterator position)
+		{
+			T* target = data() + (position - data());
+			std::memmove(target, target + 1, (end() - target - 1) * sizeof(T));
+			--this->count_;
+			return target;
+		}
+	};
+
+	// Double ended queue (ring buffer) with room for N elements inside the object
+	template<typename T, uint32_t N>
+	class InlineDeque : public InlineStorage<T, N>
+	{
+	public:
+		using value_type = T;
+		using size_type = uint32_t;
+
+		template<typename Deque, typename Value>
+		class Iterator
+		{
+		public:
+			using iterator_category = std::random_access_iterator_tag;
+			using value_type = T;
+			using difference_type = std::ptrdiff_t;
+			using pointer = Value*;
+			using reference = Value&;
+
+			Iterator(Deque* deque = nullptr, uint32_t index = 0)
+				: deque{ deque }
+				, index{ index }
+			{
+			}
+
+			// iterator converts to const_iterator
+			template<typename OtherDeque, typename OtherValue
+				, typename = typename std::enable_if<std::is_convertible<OtherValue*, Value*>::value>::type>
+			Iterator(const Iterator<OtherDeque, OtherValue>& rhs)
+				: deque{ rhs.deque }
+				, index{ rhs.index }
+			{
+			}
+
+			reference operator*() const { return (*this->deque)[this->index]; }
+			pointer operator->() const { return &(*this->deque)[this->index]; }
+			reference operator[](difference_type offset) const { return (*this->deque)[(uint32_t)(this->index + offset)]; }
+			Iterator& operator++() { ++this->index; return *this; }
+			Iterator& operator--() { --this->index; return *this; }
+			Iterator operator++(int) { Iterator old = *this; ++this->index; return old; }
+			Iterator operator--(int) { Iterator old = *this; --this->index; return old; }
+			Iterator& operator+=(difference_type offset) { this->index = (uint32_t)(this->index + offset); return *this; }
+			Iterator& operator-=(difference_type offset) { this->index = (uint32_t)(this->index - offset); return *this; }
+			Iterator operator+(difference_type offset) const { return Iterator{ this->deque, (uint32_t)(this->index + offset) }; }
+			Iterator operator-(difference_type offset) const { return Iterator{ this->deque, (uint32_t)(this->index - offset) }; }
+			uint32_t getIndex() const { return this->index; }
+
+			// Friends, so that iterators and const_iterators can be mixed through the conversion
+			friend Iterator operator+(difference_type offset, const Iterator& rhs) { return rhs + offset; }
+			friend difference_type operator-(const Iterator& lhs, const Iterator& rhs) { return (difference_type)lhs.index - (difference_type)rhs.index; }
+			friend bool operator==(const Iterator& lhs, const Iterator& rhs) { return lhs.index == rhs.index; }
+			friend bool operator!=(const Iterator& lhs, const Iterator& rhs) { return lhs.index != rhs.index; }
+			friend bool operator<(const Iterator& lhs, const Iterator& rhs) { return lhs.index < rhs.index; }
+			friend bool operator>(const Iterator& lhs, const Iterator& rhs) { return lhs.index > rhs.index; }
+			friend bool operator<=(const Iterator& lhs, const Iterator& rhs) { return lhs.index <= rhs.index; }
+			friend bool operator>=(const Iterator& lhs, const Iterator& rhs) { return lhs.index >= rhs.index; }
+		private:
+			template<typename, typename>
+			friend class Iterator;
+
+			Deque* deque;
+			uint32_t index;
+		};
+
+		using iterator = Iterator<InlineDeque, T>;
+		using const_iterator = Iterator<const InlineDeque, const T>;
+
+		InlineDeque() = default;
+
+		iterator begin() { return iterator{ this, 0 }; }
+		iterator end() { return iterator{ this, this->count_ }; }
+		const_iterator begin() const { return const_iterator{ this, 0 }; }
+		const_iterator end() const { return const_iterator{ this, this->count_ }; }
+		uint32_t size() const { return this->count_; }
+		bool empty() const { return this->count_ == 0; }
+		T& operator[](uint32_t index) { return this->elements()[wrap(this->head + index)]; }
+		const T& operator[](uint32_t index) const { return this->elements()[wrap(this->head + index)]; }
+		T& front() { return (*this)[0]; }
+		T& back() { return (*this)[this->count_ - 1]; }
+		const T& front() const { return (*this)[0]; }
+		const T& back() const { return (*this)[this->count_ - 1]; }
+
+		void push_back(const T& value)
+		{
+			growIfFull();
+			this->elements()[wrap(this->head + this->count_)] = value;
+			++this->count_;
+		}
+
+		void push_front(const T& value)
+		{
+			growIfFull();
+			this->head = this->head == 0 ? this->capacity() - 1 : this->head - 1;
+			this->elements()[this->head] = value;
+			++this->count_;
+		}
+
+		void pop_front()
+		{
+			this->head = wrap(this->head + 1);
+			--this->count_;
+		}
+
+		void pop_back()
+		{
+			--this->count_;
+		}
+
+		void clear()
+		{
+			this->count_ = 0;
+			this->head = 0;
+		}
+
+		// Inserts the value before position, the elements on the shorter side of it are moved
+		iterator insert(const_iterator position, const T& value)
+		{
+			// The value might be an element of this deque
+			T copy = value;
+			uint32_t index = position.getIndex();
+			if (index < this->count_ / 2)
+			{
+				push_front(copy);
+				for (uint32_t i = 0; i < index; ++i)
+				{
+					(*this)[i] = (*this)[i + 1];
+				}
+			}
+			else
+			{
+				push_back(copy);
+				for (uint32_t i = this->count_ - 1; i > index; --i)
+				{
+					(*this)[i] = (*this)[i - 1];
+				}
+			}
+			(*this)[index] = copy;
+			return iterator{ this, index };
+		}
+
+		// Removes the element at position, the elements on the shorter side of it are moved
+		iterator erase(const_iterator position)
+		{
+			uint32_t index = position.getIndex();
+			if (index < this->count_ / 2)
+			{
+				for (uint32_t i = index; i > 0; --i)
+				{
+					(*this)[i] = (*this)[i - 1];
+				}
+				pop_front();
+			}
+			else
+			{
+				for (uint32_t i = index; i + 1 < this->count_; ++i)
+				{
+					(*this)[i] = (*this)[i + 1];
+				}
+				pop_back();
+			}
+			return iterator{ this, index };
+		}
+	private:
+		uint32_t wrap(uint32_t index) const
+		{
+			return index >= this->capacity() ? index - this->capacity() : index;
+		}
+
+		void growIfFull()
+		{
+			if (this->count_ == this->capacity())
+			{
+				this->grow(this->capacity() * 2, this->head, this->count_);
+				this->head = 0;
+			}
+		}
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
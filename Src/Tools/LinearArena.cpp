@@ -0,0 +1,147 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "LinearArena.h"
+
+#include <algorithm>
+
+#include "base/Macros.h" // for RioAssert
+
+namespace RioGame
+{
+
+	LinearArena::LinearArena(size_t blockSize)
+		: blockSize{ blockSize }
+	{
+	}
+
+	LinearArena::LinearArena(LinearArena&& rhs)
+		: blockSize{ rhs.blockSize }
+		, blocks{ std::move(rhs.blocks) }
+		, currentBlock{ rhs.currentBlock }
+		, offset{ rhs.offset }
+		, usedBytes{ rhs.usedBytes }
+	{
+		rhs.blocks.clear();
+		rhs.currentBlock = 0;
+		rhs.offset = 0;
+		rhs.usedBytes = 0;
+	}
+
+	LinearArena& LinearArena::operator=(LinearArena&& rhs)
+	{
+		if (this != &rhs)
+		{
+			release();
+			this->blockSize = rhs.blockSize;
+			this->blocks = std::move(rhs.blocks);
+			this->currentBlock = rhs.currentBlock;
+			this->offset = rhs.offset;
+			this->usedBytes = rhs.usedBytes;
+			rhs.blocks.clear();
+			rhs.currentBlock = 0;
+			rhs.offset = 0;
+			rhs.usedBytes = 0;
+		}
+		return *this;
+	}
+
+	LinearArena::~LinearArena()
+	{
+		release();
+	}
+
+	void* LinearArena::allocate(size_t size, size_t alignment)
+	{
+		RioAssert(alignment != 0 && (alignment & (alignment - 1)) == 0, "Alignment has to be a power of two");
+
+		while (this->currentBlock < this->blocks.size())
+		{
+			Block& block = this->blocks[this->currentBlock];
+			uintptr_t address = reinterpret_cast<uintptr_t>(block.memory) + this->offset;
+			size_t padding = (alignment - (address & (alignment - 1))) & (alignment - 1);
+			if (this->offset + padding + size <= block.size)
+			{
+				this->offset += padding + size;
+				this->usedBytes += padding + size;
+				return reinterpret_cast<void*>(address + padding);
+			}
+
+			++this->currentBlock;
+			this->offset = 0;
+		}
+
+		// operator new memory is aligned for any fundamental type, bigger alignments get extra space
+		size_t newBlockSize = std::max(this->blockSize, size + alignment);
+		this->blocks.push_back(Block{ static_cast<char*>(::operator new(newBlockSize)), newBlockSize });
+		this->currentBlock = this->blocks.size() - 1;
+		this->offset = 0;
+		return allocate(size, alignment);
+	}
+
+	void LinearArena::reset()
+	{
+		if (this->blocks.size() > 1)
+		{
+			size_t total = 0;
+			for (auto& block : this->blocks)
+			{
+				total += block.size;
+			}
+
+			release();
+			this->blocks.push_back(Block{ static_cast<char*>(::operator new(total)), total });
+		}
+
+		this->currentBlock = 0;
+		this->offset = 0;
+		this->usedBytes = 0;
+	}
+
+	size_t LinearArena::getUsedBytes() const
+	{
+		return this->usedBytes;
+	}
+
+	size_t LinearArena::getCapacity() const
+	{
+		size_t capacity = 0;
+		for (auto& block : this->blocks)
+		{
+			capacity += block.size;
+		}
+		return capacity;
+	}
+
+	void LinearArena::release()
+	{
+		for (auto& block : this->blocks)
+		{
+			::operator delete(block.memory);
+		}
+		this->blocks.clear();
+	}
+
+	ThreadArenas::ThreadArenas(uint32_t threadCount, size_t blockSize)
+	{
+		this->arenas.reserve(threadCount);
+		for (uint32_t i = 0; i < threadCount; ++i)
+		{
+			this->arenas.emplace_back(blockSize);
+		}
+	}
+
+	LinearArena& ThreadArenas::get(uint32_t thread)
+	{
+		RioAssert(thread < this->arenas.size(), "No arena for this thread");
+		return this->arenas[thread];
+	}
+
+	void ThreadArenas::reset()
+	{
+		for (auto& arena : this->arenas)
+		{
+			arena.reset();
+		}
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
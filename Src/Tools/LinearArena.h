@@ -0,0 +1,126 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace RioGame
+{
+
+	// Bump allocator for short lived data, individual allocations are never freed,
+	// reset() releases everything at once. Not thread safe, every thread uses its own arena
+	class LinearArena
+	{
+	public:
+		explicit LinearArena(size_t blockSize = 64 * 1024);
+		LinearArena(const LinearArena&) = delete;
+		LinearArena& operator=(const LinearArena&) = delete;
+		LinearArena(LinearArena&& rhs);
+		LinearArena& operator=(LinearArena&& rhs);
+		~LinearArena();
+
+		void* allocate(size_t size, size_t alignment);
+		// Invalidates all allocations, if the last use needed more than one block
+		// they are replaced by a single block big enough for all of them
+		void reset();
+
+		size_t getUsedBytes() const;
+		size_t getCapacity() const;
+	private:
+		struct Block
+		{
+			char* memory;
+			size_t size;
+		};
+
+		void release();
+
+		size_t blockSize;
+		std::vector<Block> blocks;
+		// Block allocations are currently served from and the offset in it
+		size_t currentBlock = 0;
+		size_t offset = 0;
+		size_t usedBytes = 0;
+	};
+
+	// One arena per thread of a ThreadPool (indexed by the thread index jobs receive)
+	class ThreadArenas
+	{
+	public:
+		explicit ThreadArenas(uint32_t threadCount, size_t blockSize = 64 * 1024);
+
+		LinearArena& get(uint32_t thread);
+		// Must only be called while no job uses the arenas
+		void reset();
+	private:
+		std::vector<LinearArena> arenas;
+	};
+
+	// Standard allocator adaptor, allows std containers to live in a LinearArena
+	// The allocator propagates with the container, so containers from different arenas can be moved and swapped
+	template<typename T>
+	class ArenaAllocator
+	{
+	public:
+		using value_type = T;
+		using propagate_on_container_copy_assignment = std::true_type;
+		using propagate_on_container_move_assignment = std::true_type;
+		using propagate_on_container_swap = std::true_type;
+
+		explicit ArenaAllocator(LinearArena* arena = nullptr)
+			: arena{ arena }
+		{
+		}
+
+		template<typename U>
+		ArenaAllocator(const ArenaAllocator<U>& rhs)
+			: arena{ rhs.getArena() }
+		{
+		}
+
+		T* allocate(size_t count)
+		{
+			// Containers without an arena fall back to the global heap
+			if (this->arena == nullptr)
+			{
+				return std::allocator<T>{}.allocate(count);
+			}
+			return static_cast<T*>(this->arena->allocate(count * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T* pointer, size_t count)
+		{
+			if (this->arena == nullptr)
+			{
+				std::allocator<T>{}.deallocate(pointer, count);
+			}
+		}
+
+		LinearArena* getArena() const
+		{
+			return this->arena;
+		}
+	private:
+		LinearArena* arena;
+	};
+
+	template<typename T, typename U>
+	bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs)
+	{
+		return lhs.getArena() == rhs.getArena();
+	}
+
+	template<typename T, typename U>
+	bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs)
+	{
+		return !(lhs == rhs);
+	}
+
+	template<typename T>
+	using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
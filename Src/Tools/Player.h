@@ -70,6 +70,10 @@ namespace RioGame
 		uint32_t getMaxMana() const;
 		// Returns the value of the player's mana regeneration
 		uint32_t getManaRegen() const;
+		// Returns the amount of currently alive units
+		uint32_t getCurrentUnitCount() const { return currentlyAliveUnitCount; }
+		// Returns the amount of all units (even those that are respawning)
+		uint32_t getMaxUnitCount() const { return maxUnitCount; }
 		// Sets all of the player's stats to their default values
 		void reset();
 		// Sets all of the player's stats to zero (used for loading)
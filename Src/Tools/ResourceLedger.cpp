@@ -0,0 +1,80 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "ResourceLedger.h"
+
+#include <algorithm>
+
+#include "base/Macros.h" // for RioAssert
+
+namespace RioGame
+{
+
+	ResourceLedger::ResourceLedger(uint32_t threadCount)
+		: buffers(threadCount)
+	{
+		for (uint32_t i = 0; i < (uint32_t)Resource::COUNT; ++i)
+		{
+			reset((Resource)i, 0);
+		}
+	}
+
+	void ResourceLedger::deposit(uint32_t thread, Resource resource, uint32_t amount)
+	{
+		RioAssert(thread < this->buffers.size(), "No buffer for this thread");
+		this->buffers[thread].amounts[(uint32_t)resource] += amount;
+	}
+
+	bool ResourceLedger::spend(Resource resource, uint32_t amount)
+	{
+		std::atomic<uint32_t>& balance = this->balances[(uint32_t)resource];
+		uint32_t current = balance.load(std::memory_order_relaxed);
+		// A failed exchange reloads current, so concurrent spends are retried against the new balance
+		do
+		{
+			if (current < amount)
+			{
+				return false;
+			}
+		} while (!balance.compare_exchange_weak(current, current - amount, std::memory_order_relaxed));
+		return true;
+	}
+
+	uint32_t ResourceLedger::get(Resource resource) const
+	{
+		return this->balances[(uint32_t)resource].load(std::memory_order_relaxed);
+	}
+
+	void ResourceLedger::commit()
+	{
+		for (uint32_t i = 0; i < (uint32_t)Resource::COUNT; ++i)
+		{
+			int64_t sum = 0;
+			for (auto& buffer : this->buffers)
+			{
+				sum += buffer.amounts[i];
+				buffer.amounts[i] = 0;
+			}
+			if (sum != 0)
+			{
+				int64_t balance = std::min<int64_t>(this->balances[i].load(std::memory_order_relaxed) + sum, this->limits[i]);
+				this->balances[i].store((uint32_t)balance, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	void ResourceLedger::reset(Resource resource, uint32_t balance, uint32_t limit)
+	{
+		this->balances[(uint32_t)resource].store(balance, std::memory_order_relaxed);
+		this->limits[(uint32_t)resource] = limit;
+		this->references[(uint32_t)resource] = balance;
+	}
+
+	int64_t ResourceLedger::takeChange(Resource resource)
+	{
+		uint32_t balance = get(resource);
+		int64_t change = (int64_t)balance - this->references[(uint32_t)resource];
+		this->references[(uint32_t)resource] = balance;
+		return change;
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
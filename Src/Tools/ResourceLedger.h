@@ -0,0 +1,59 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace RioGame
+{
+
+	enum class Resource : uint8_t
+	{
+		GOLD = 0,
+		MANA,
+		// Currently alive units
+		UNITS,
+		COUNT
+	};
+
+	// Player resources that systems running in parallel can change
+	// Income goes to a buffer of the depositing thread (indexed by the thread index jobs receive) and
+	// is merged into the balances by commit at the sync point, spends are checked and taken from
+	// the balance atomically, so a spend never takes more than the committed balance
+	// The main thread uses the index of the thread helping out in ThreadPool::wait (getWorkerCount())
+	class ResourceLedger
+	{
+	public:
+		explicit ResourceLedger(uint32_t threadCount);
+		ResourceLedger(const ResourceLedger&) = delete;
+		ResourceLedger& operator=(const ResourceLedger&) = delete;
+
+		// Adds the amount to the resource at the next commit, only the given thread may use its buffer
+		void deposit(uint32_t thread, Resource resource, uint32_t amount);
+		// Takes the amount from the resource if the balance allows it, returns false otherwise
+		bool spend(Resource resource, uint32_t amount);
+		uint32_t get(Resource resource) const;
+
+		// The following must only be called while no job uses the ledger
+		// Merges the deposits into the balances, balances are clamped to their limits
+		void commit();
+		// Sets the balance (and the reference the changes are measured from) and the limit of a resource
+		void reset(Resource resource, uint32_t balance, uint32_t limit = uint32_t(-1));
+		// Returns the change of the resource since the last reset or takeChange call
+		int64_t takeChange(Resource resource);
+	private:
+		// Each thread's buffer on its own cache line
+		struct alignas(64) Buffer
+		{
+			int64_t amounts[(uint32_t)Resource::COUNT] = {};
+		};
+
+		std::atomic<uint32_t> balances[(uint32_t)Resource::COUNT];
+		uint32_t limits[(uint32_t)Resource::COUNT];
+		uint32_t references[(uint32_t)Resource::COUNT];
+		std::vector<Buffer> buffers;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,88 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "SlabAllocator.h"
+
+#include <new>
+
+namespace RioGame
+{
+
+	SlabAllocator& SlabAllocator::getInstance()
+	{
+		// Never destroyed, components of static objects might still return blocks during shutdown
+		static SlabAllocator* instance = new SlabAllocator{};
+		return *instance;
+	}
+
+	SlabAllocator::~SlabAllocator()
+	{
+		for (auto& sizeClass : this->classes)
+		{
+			for (auto slab : sizeClass.slabs)
+			{
+				::operator delete(slab);
+			}
+		}
+	}
+
+	void* SlabAllocator::allocate(size_t size)
+	{
+		if (size > maxBlockSize)
+		{
+			return ::operator new(size);
+		}
+
+		uint32_t classIndex = getClass(size);
+		size_t blockSize = minBlockSize << classIndex;
+		SizeClass& sizeClass = this->classes[classIndex];
+		std::lock_guard<std::mutex> lock{ sizeClass.mutex };
+
+		if (sizeClass.freeList == nullptr)
+		{
+			// Carves a new slab into blocks and puts them all on the free list
+			char* slab = static_cast<char*>(::operator new(slabSize));
+			sizeClass.slabs.push_back(slab);
+			for (size_t offset = slabSize; offset >= blockSize; offset -= blockSize)
+			{
+				FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + offset - blockSize);
+				block->next = sizeClass.freeList;
+				sizeClass.freeList = block;
+			}
+		}
+
+		FreeBlock* block = sizeClass.freeList;
+		sizeClass.freeList = block->next;
+		return block;
+	}
+
+	void SlabAllocator::deallocate(void* pointer, size_t size)
+	{
+		if (pointer == nullptr)
+		{
+			return;
+		}
+
+		if (size > maxBlockSize)
+		{
+			::operator delete(pointer);
+			return;
+		}
+
+		SizeClass& sizeClass = this->classes[getClass(size)];
+		std::lock_guard<std::mutex> lock{ sizeClass.mutex };
+		FreeBlock* block = static_cast<FreeBlock*>(pointer);
+		block->next = sizeClass.freeList;
+		sizeClass.freeList = block;
+	}
+
+	uint32_t SlabAllocator::getClass(size_t size)
+	{
+		uint32_t classIndex = 0;
+		while ((minBlockSize << classIndex) < size)
+		{
+			++classIndex;
+		}
+		return classIndex;
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
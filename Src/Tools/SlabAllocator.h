@@ -0,0 +1,55 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace RioGame
+{
+
+	// Pool of fixed size blocks in power of two size classes (32 to 4096 bytes), shared by the
+	// inline containers of components once they outgrow their inline storage
+	// Freed blocks go back to the free list of their class and are never returned to the system,
+	// bigger requests are passed to the global heap. Thread safe (one lock per size class)
+	class SlabAllocator
+	{
+	public:
+		static constexpr size_t minBlockSize = 32;
+		static constexpr size_t maxBlockSize = 4096;
+		static constexpr size_t slabSize = 64 * 1024;
+
+		static SlabAllocator& getInstance();
+
+		SlabAllocator() = default;
+		SlabAllocator(const SlabAllocator&) = delete;
+		SlabAllocator& operator=(const SlabAllocator&) = delete;
+		~SlabAllocator();
+
+		void* allocate(size_t size);
+		// The size has to be the one the block was allocated with
+		void deallocate(void* pointer, size_t size);
+	private:
+		static constexpr uint32_t classCount = 8;
+
+		struct FreeBlock
+		{
+			FreeBlock* next;
+		};
+
+		struct SizeClass
+		{
+			std::mutex mutex;
+			FreeBlock* freeList = nullptr;
+			std::vector<char*> slabs;
+		};
+
+		static uint32_t getClass(size_t size);
+
+		std::array<SizeClass, classCount> classes;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,144 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "SpriteAtlas.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "2d/CCSpriteFrameCache.h"
+
+namespace RioGame
+{
+
+	using ::RioEngine::SpriteFrameCache;
+
+	void SpriteAtlas::load(const std::string& indexPath, Node* layer)
+	{
+		std::ifstream index{ indexPath };
+		if (!index)
+		{
+			throw std::runtime_error{ "Could not open atlas index " + indexPath };
+		}
+
+		size_t slash = indexPath.find_last_of("/\\");
+		std::string directory = slash != std::string::npos ? indexPath.substr(0, slash + 1) : "";
+		uint32_t firstPage = (uint32_t)this->batches.size();
+		this->layer = layer;
+
+		std::string line;
+		while (std::getline(index, line))
+		{
+			std::istringstream words{ line };
+			std::string kind;
+			words >> kind;
+			if (kind == "page")
+			{
+				std::string plist, texture;
+				words >> plist >> texture;
+				SpriteFrameCache::getInstance()->addSpriteFramesWithFile(directory + plist, directory + texture);
+				SpriteBatchNode* batch = SpriteBatchNode::create(directory + texture);
+				if (batch == nullptr)
+				{
+					throw std::runtime_error{ "Could not load atlas page " + directory + texture };
+				}
+				layer->addChild(batch);
+				this->batches.push_back(batch);
+				this->plists.push_back(directory + plist);
+			}
+			else if (kind == "sprite")
+			{
+				std::string name;
+				uint32_t page;
+				words >> name >> page;
+				if (firstPage + page >= this->batches.size())
+				{
+					throw std::runtime_error{ "Atlas index " + indexPath + " references a missing page" };
+				}
+				this->pages[name] = firstPage + page;
+			}
+		}
+	}
+
+	bool SpriteAtlas::contains(const std::string& sprite) const
+	{
+		return this->pages.count(sprite) > 0;
+	}
+
+	Sprite* SpriteAtlas::createSprite(const std::string& sprite, Node* fallbackParent)
+	{
+		auto page = this->pages.find(sprite);
+		if (page == this->pages.end())
+		{
+			Sprite* standalone = Sprite::create(sprite);
+			if (standalone != nullptr && fallbackParent != nullptr)
+			{
+				fallbackParent->addChild(standalone);
+			}
+			return standalone;
+		}
+
+		Sprite* batched = Sprite::createWithSpriteFrameName(sprite);
+		if (batched != nullptr)
+		{
+			this->batches[page->second]->addChild(batched);
+		}
+		return batched;
+	}
+
+	void SpriteAtlas::setSprite(Sprite* sprite, const std::string& name)
+	{
+		Node* parent = sprite->getParent();
+		auto page = this->pages.find(name);
+		Node* target = page != this->pages.end() ? this->batches[page->second] : nullptr;
+		bool batched = std::find(this->batches.begin(), this->batches.end(), parent) != this->batches.end();
+		if (target == nullptr && (!batched || this->layer == nullptr))
+		{
+			sprite->setTexture(name);
+			return;
+		}
+		if (target == parent)
+		{
+			sprite->setSpriteFrame(name);
+			return;
+		}
+
+		// A batch only takes sprites with its own texture, so the sprite leaves its parent first
+		sprite->retain();
+		sprite->removeFromParent();
+		if (target != nullptr)
+		{
+			sprite->setSpriteFrame(name);
+			target->addChild(sprite);
+		}
+		else
+		{
+			sprite->setTexture(name);
+			this->layer->addChild(sprite);
+		}
+		sprite->release();
+	}
+
+	uint32_t SpriteAtlas::getPageCount() const
+	{
+		return (uint32_t)this->batches.size();
+	}
+
+	void SpriteAtlas::clear()
+	{
+		for (auto batch : this->batches)
+		{
+			batch->removeFromParent();
+		}
+		for (const auto& plist : this->plists)
+		{
+			SpriteFrameCache::getInstance()->removeSpriteFramesFromFile(plist);
+		}
+		this->batches.clear();
+		this->plists.clear();
+		this->pages.clear();
+		this->layer = nullptr;
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,53 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "2d/CCNode.h"
+#include "2d/CCSprite.h"
+#include "2d/CCSpriteBatchNode.h"
+
+namespace RioGame
+{
+
+	using ::RioEngine::Node;
+	using ::RioEngine::Sprite;
+	using ::RioEngine::SpriteBatchNode;
+
+	// Run time side of the atlases built by the AtlasPacker
+	// Every atlas page gets one SpriteBatchNode, sprites created through the atlas are children of the
+	// batch of their page, so all entities using the same page are drawn with a single draw call
+	class SpriteAtlas
+	{
+	public:
+		SpriteAtlas() = default;
+		SpriteAtlas(const SpriteAtlas&) = delete;
+		SpriteAtlas& operator=(const SpriteAtlas&) = delete;
+
+		// Loads the index written by the AtlasPacker (pages are relative to it), registers the frames
+		// with the SpriteFrameCache and adds the batch nodes to the layer, throws std::runtime_error on failure
+		void load(const std::string& indexPath, Node* layer);
+		bool contains(const std::string& sprite) const;
+		// Creates the sprite in the batch of its page, sprites missing from the atlases are created
+		// from their own texture and added to fallbackParent
+		Sprite* createSprite(const std::string& sprite, Node* fallbackParent);
+		// Shows another sprite on an existing one, atlas frames are switched inside their page's batch
+		// (the sprite moves to the batch of the new page if needed), other sprites get their own texture
+		// outside of the batches
+		void setSprite(Sprite* sprite, const std::string& name);
+		uint32_t getPageCount() const;
+		// Removes the batch nodes and the frames of the pages
+		void clear();
+	private:
+		std::vector<SpriteBatchNode*> batches;
+		std::vector<std::string> plists;
+		std::unordered_map<std::string, uint32_t> pages;
+		// Layer the batches were added to, parent of the sprites moved out of a batch
+		Node* layer = nullptr;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
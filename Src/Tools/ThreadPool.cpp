@@ -0,0 +1,162 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace RioGame
+{
+
+	bool JobGroup::isDone() const
+	{
+		return this->pending.load() == 0;
+	}
+
+	ThreadPool::ThreadPool(uint32_t workerCount)
+	{
+		if (workerCount == 0)
+		{
+			uint32_t hardwareThreads = std::thread::hardware_concurrency();
+			workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		}
+
+		this->workers.reserve(workerCount);
+		for (uint32_t i = 0; i < workerCount; ++i)
+		{
+			this->workers.emplace_back(&ThreadPool::work, this, i);
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ this->mutex };
+			this->stopping = true;
+		}
+		this->available.notify_all();
+
+		for (auto& worker : this->workers)
+		{
+			worker.join();
+		}
+	}
+
+	void ThreadPool::submit(JobGroup& group, Job job)
+	{
+		push(this->queue, group, std::move(job));
+	}
+
+	void ThreadPool::submitBackground(JobGroup& group, Job job)
+	{
+		push(this->background, group, std::move(job));
+	}
+
+	void ThreadPool::wait(JobGroup& group)
+	{
+		uint32_t thread = getWorkerCount();
+		std::unique_lock<std::mutex> lock{ this->mutex };
+
+		// Jobs of other groups are left to the workers, a long background job
+		// must not hold up the caller of a parallelFor
+		Entry entry;
+		while (group.pending.load() > 0)
+		{
+			if (take(&group, entry))
+			{
+				lock.unlock();
+				run(entry, thread);
+				lock.lock();
+			}
+			else
+			{
+				this->changed.wait(lock);
+			}
+		}
+	}
+
+	void ThreadPool::parallelFor(uint32_t count, uint32_t grain, const RangeJob& job)
+	{
+		JobGroup group;
+		grain = std::max(grain, 1u);
+
+		for (uint32_t begin = 0; begin < count; begin += grain)
+		{
+			uint32_t end = std::min(begin + grain, count);
+			submit(group, [&job, begin, end](uint32_t thread) { job(begin, end, thread); });
+		}
+		wait(group);
+	}
+
+	uint32_t ThreadPool::getWorkerCount() const
+	{
+		return (uint32_t)this->workers.size();
+	}
+
+	uint32_t ThreadPool::getThreadCount() const
+	{
+		return getWorkerCount() + 1;
+	}
+
+	void ThreadPool::push(std::deque<Entry>& queue, JobGroup& group, Job job)
+	{
+		{
+			std::lock_guard<std::mutex> lock{ this->mutex };
+			++group.pending;
+			queue.push_back(Entry{ std::move(job), &group });
+		}
+		this->available.notify_one();
+		this->changed.notify_all();
+	}
+
+	bool ThreadPool::take(JobGroup* group, Entry& entry)
+	{
+		for (auto* queue : { &this->queue, &this->background })
+		{
+			auto found = queue->begin();
+			if (group != nullptr)
+			{
+				found = std::find_if(queue->begin(), queue->end(), [group](const Entry& queued) { return queued.group == group; });
+			}
+
+			if (found != queue->end())
+			{
+				entry = std::move(*found);
+				queue->erase(found);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void ThreadPool::work(uint32_t thread)
+	{
+		for (;;)
+		{
+			Entry entry;
+			{
+				std::unique_lock<std::mutex> lock{ this->mutex };
+				this->available.wait(lock, [this]() {
+					return this->stopping || !this->queue.empty() || !this->background.empty();
+				});
+				if (!take(nullptr, entry))
+				{
+					return;
+				}
+			}
+			run(entry, thread);
+		}
+	}
+
+	void ThreadPool::run(Entry& entry, uint32_t thread)
+	{
+		entry.job(thread);
+
+		// Decremented under the lock, so that a waiting thread can't miss the notification
+		std::lock_guard<std::mutex> lock{ this->mutex };
+		if (--entry.group->pending == 0)
+		{
+			this->changed.notify_all();
+		}
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
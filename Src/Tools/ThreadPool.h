@@ -0,0 +1,85 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace RioGame
+{
+
+	class ThreadPool;
+
+	// Counts the unfinished jobs of a batch so that a caller can wait only for its own jobs
+	class JobGroup
+	{
+	public:
+		JobGroup() = default;
+		JobGroup(const JobGroup&) = delete;
+		JobGroup& operator=(const JobGroup&) = delete;
+
+		bool isDone() const;
+	private:
+		friend class ThreadPool;
+		std::atomic<uint32_t> pending{ 0 };
+	};
+
+	// Fixed set of worker threads executing jobs from a shared queue, background jobs
+	// (that may run until the next frame) are only taken when no other job is queued
+	// Jobs get the index of the thread running them, workers have indices [0, getWorkerCount())
+	// and a thread helping out while waiting for a group gets getWorkerCount(),
+	// so per thread scratch data needs getThreadCount() entries
+	class ThreadPool
+	{
+	public:
+		using Job = std::function<void(uint32_t thread)>;
+		using RangeJob = std::function<void(uint32_t begin, uint32_t end, uint32_t thread)>;
+
+		// Zero workers means one less than the amount of hardware threads (at least one)
+		explicit ThreadPool(uint32_t workerCount = 0);
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+		// Finishes all queued jobs and joins the workers
+		~ThreadPool();
+
+		void submit(JobGroup& group, Job job);
+		void submitBackground(JobGroup& group, Job job);
+		// Blocks until all jobs of the group finished, executing queued jobs of the group in the meantime
+		void wait(JobGroup& group);
+		// Splits [0, count) into ranges of at most grain elements, runs them in parallel and waits for them
+		void parallelFor(uint32_t count, uint32_t grain, const RangeJob& job);
+
+		uint32_t getWorkerCount() const;
+		uint32_t getThreadCount() const;
+	private:
+		struct Entry
+		{
+			Job job;
+			JobGroup* group;
+		};
+
+		void push(std::deque<Entry>& queue, JobGroup& group, Job job);
+		// Removes the first queued entry (of the group unless it's nullptr), has to be called under the lock
+		bool take(JobGroup* group, Entry& entry);
+		void work(uint32_t thread);
+		// Runs the entry and marks it finished in its group
+		void run(Entry& entry, uint32_t thread);
+
+		std::vector<std::thread> workers;
+		std::deque<Entry> queue;
+		std::deque<Entry> background;
+		std::mutex mutex;
+		// Signalled when a job is queued
+		std::condition_variable available;
+		// Signalled when a job is queued or a group is finished, used by threads waiting for a group
+		std::condition_variable changed;
+		bool stopping = false;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,129 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "AiScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "Components.h"
+#include "EntityManager.h"
+
+namespace RioGame
+{
+
+	AiScheduler::AiScheduler(EntityManager& entityManager)
+		: entityManager(entityManager)
+	{
+	}
+
+	void AiScheduler::process(const ThinkFunction& think)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		++this->frame;
+		this->urgent.clear();
+		this->scheduled.clear();
+		std::sort(this->deferred.begin(), this->deferred.end());
+
+		float nearRadiusSquared = this->nearRadius * this->nearRadius;
+		for (auto& entry : this->entityManager.getComponentContainer<AiComponent>())
+		{
+			uint32_t id = entry.first;
+			auto physics = this->entityManager.getComponent<PhysicsComponent>(id);
+			auto combat = this->entityManager.getComponent<CombatComponent>(id);
+
+			bool isNear = physics != nullptr && physics->position.distanceSquared(this->focus) <= nearRadiusSquared;
+			bool inCombat = combat != nullptr && combat->currentTarget != Component::NO_ENTITY;
+			if (isNear || inCombat)
+			{
+				this->urgent.push_back(id);
+			}
+			else if ((id + this->frame) % this->farInterval == 0
+				&& !std::binary_search(this->deferred.begin(), this->deferred.end(), id))
+			{
+				this->scheduled.push_back(id);
+			}
+		}
+
+		// Urgent entities always think, they are not limited by the budget
+		for (auto id : this->urgent)
+		{
+			think(id);
+		}
+
+		// Entities deferred in the last frame go first, unless they were destroyed or became urgent
+		std::sort(this->urgent.begin(), this->urgent.end());
+		auto deferredEnd = std::remove_if(this->deferred.begin(), this->deferred.end(), [this](uint32_t id) {
+			return !this->entityManager.hasComponent<AiComponent>(id)
+				|| std::binary_search(this->urgent.begin(), this->urgent.end(), id);
+		});
+		this->scheduled.insert(this->scheduled.begin(), this->deferred.begin(), deferredEnd);
+		this->deferred.clear();
+
+		auto start = Clock::now();
+		for (uint32_t i = 0; i < this->scheduled.size(); ++i)
+		{
+			// Reading the clock for every entity would cost more than a cheap think
+			if (i % 8 == 0 && i > 0)
+			{
+				float elapsed = std::chrono::duration<float, std::micro>(Clock::now() - start).count();
+				if (elapsed > this->currentBudget)
+				{
+					this->deferred.assign(this->scheduled.begin() + i, this->scheduled.end());
+					break;
+				}
+			}
+			think(this->scheduled[i]);
+		}
+	}
+
+	void AiScheduler::reportFrameTime(float milliseconds)
+	{
+		if (milliseconds > this->targetFrameTime)
+		{
+			this->currentBudget = std::max(this->currentBudget * 0.75f, this->minBudget);
+		}
+		else
+		{
+			this->currentBudget = std::min(this->currentBudget * 1.05f, this->maxBudget);
+		}
+	}
+
+	void AiScheduler::setFocus(const Vec2& position)
+	{
+		this->focus = position;
+	}
+
+	void AiScheduler::setNearRadius(float radius)
+	{
+		this->nearRadius = radius;
+	}
+
+	void AiScheduler::setFarInterval(uint32_t frames)
+	{
+		this->farInterval = std::max(frames, 1u);
+	}
+
+	void AiScheduler::setBudget(float microseconds, float minMicroseconds)
+	{
+		this->maxBudget = microseconds;
+		this->minBudget = std::min(minMicroseconds, microseconds);
+		this->currentBudget = microseconds;
+	}
+
+	void AiScheduler::setTargetFrameTime(float milliseconds)
+	{
+		this->targetFrameTime = milliseconds;
+	}
+
+	float AiScheduler::getCurrentBudget() const
+	{
+		return this->currentBudget;
+	}
+
+	uint32_t AiScheduler::getDeferredCount() const
+	{
+		return (uint32_t)this->deferred.size();
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,67 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "math/Vec2.h"
+
+namespace RioGame
+{
+
+	using ::RioEngine::Vec2;
+
+	class EntityManager;
+
+	// Level of detail for AI, decides which entities get to think in the current frame
+	// Entities close to the focus point (camera) or in combat think every frame, the rest
+	// is split into farInterval groups by id and each frame one group thinks within a time budget
+	// Entities that didn't fit into the budget are deferred and think first in the next frame
+	class AiScheduler
+	{
+	public:
+		using ThinkFunction = std::function<void(uint32_t entity)>;
+
+		explicit AiScheduler(EntityManager& entityManager);
+		AiScheduler(const AiScheduler&) = delete;
+		AiScheduler& operator=(const AiScheduler&) = delete;
+
+		// Calls think for every entity with an AiComponent that is scheduled for this frame
+		void process(const ThinkFunction& think);
+		// Reports the duration of the last frame, if it's over the target the think
+		// budget shrinks (down to the minimal budget), otherwise it slowly recovers
+		void reportFrameTime(float milliseconds);
+
+		// Sets the point around which entities think every frame (usually the camera position)
+		void setFocus(const Vec2& position);
+		void setNearRadius(float radius);
+		// Sets the amount of groups far entities are split into (a group thinks every frame)
+		void setFarInterval(uint32_t frames);
+		// Sets the time far entities can spend thinking in a frame (in microseconds)
+		void setBudget(float microseconds, float minMicroseconds);
+		// Sets the frame time over which the budget shrinks (in milliseconds)
+		void setTargetFrameTime(float milliseconds);
+
+		float getCurrentBudget() const;
+		uint32_t getDeferredCount() const;
+	private:
+		EntityManager& entityManager;
+
+		Vec2 focus;
+		float nearRadius = 20.0f;
+		uint32_t farInterval = 4;
+		float maxBudget = 2000.0f;
+		float minBudget = 250.0f;
+		float currentBudget = 2000.0f;
+		float targetFrameTime = 16.0f;
+		uint32_t frame = 0;
+
+		// Reused every frame to avoid reallocation
+		std::vector<uint32_t> urgent;
+		std::vector<uint32_t> scheduled;
+		std::vector<uint32_t> deferred;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
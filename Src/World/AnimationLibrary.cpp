@@ -0,0 +1,210 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "AnimationLibrary.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#include "2d/CCSprite.h"
+
+#include "Components.h"
+#include "EntityManager.h"
+#include "Tools/BlueprintPipeline.h"
+#include "Tools/ThreadPool.h"
+
+namespace RioGame
+{
+
+	constexpr uint32_t AnimationLibrary::NO_CLIP;
+
+	using ::RioEngine::Sprite;
+
+	namespace
+	{
+		const char* const animationNames[AnimationType::COUNT] = { "WALK", "IDLE", "HIT", "ACTIVATE", "DEACTIVATE" };
+		const uint32_t NO_FRAME = uint32_t(-1);
+	}
+
+	uint32_t AnimationLibrary::getClipSet(const std::string& blueprint)
+	{
+		auto it = this->clipSetIds.find(blueprint);
+		if (it != this->clipSetIds.end())
+		{
+			return it->second;
+		}
+
+		std::array<uint32_t, AnimationType::COUNT> clipSet;
+		clipSet.fill(NO_CLIP);
+		this->clipSets.push_back(clipSet);
+		uint32_t id = (uint32_t)this->clipSets.size() - 1;
+		this->clipSetIds.emplace(blueprint, id);
+		return id;
+	}
+
+	uint32_t AnimationLibrary::addClip(const std::string& blueprint, AnimationType::ENUM type
+		, const std::vector<std::string>& frames, float framesPerSecond, bool loop)
+	{
+		if (frames.empty() || framesPerSecond <= 0.0f)
+		{
+			throw std::runtime_error{ "Animation clip of " + blueprint + " needs frames and a positive frame rate" };
+		}
+
+		AnimationClip clip{ (uint32_t)this->frameNames.size(), (uint32_t)frames.size(), 1.0f / framesPerSecond, loop };
+		uint32_t& id = this->clipSets[getClipSet(blueprint)][type];
+		if (id == NO_CLIP)
+		{
+			this->frameNames.insert(this->frameNames.end(), frames.begin(), frames.end());
+			this->clips.push_back(clip);
+			id = (uint32_t)this->clips.size() - 1;
+			return id;
+		}
+
+		// Entities playing the clip keep its id, the frames are replaced where they were if they fit
+		AnimationClip& old = this->clips[id];
+		if (clip.frameCount <= old.frameCount)
+		{
+			clip.firstFrame = old.firstFrame;
+			std::copy(frames.begin(), frames.end(), this->frameNames.begin() + clip.firstFrame);
+			this->unusedFrames += old.frameCount - clip.frameCount;
+		}
+		else
+		{
+			this->frameNames.insert(this->frameNames.end(), frames.begin(), frames.end());
+			this->unusedFrames += old.frameCount;
+		}
+		old = clip;
+
+		// Blueprints reloaded again and again would grow the frame names forever
+		if (this->unusedFrames > this->frameNames.size() / 2)
+		{
+			compactFrames();
+		}
+		return id;
+	}
+
+	void AnimationLibrary::compactFrames()
+	{
+		// Frame indices aren't stored anywhere but in the clips
+		std::vector<std::string> frameNames;
+		frameNames.reserve(this->frameNames.size() - this->unusedFrames);
+		for (auto& clip : this->clips)
+		{
+			auto first = this->frameNames.begin() + clip.firstFrame;
+			clip.firstFrame = (uint32_t)frameNames.size();
+			frameNames.insert(frameNames.end(), std::make_move_iterator(first), std::make_move_iterator(first + clip.frameCount));
+		}
+		this->frameNames.swap(frameNames);
+		this->unusedFrames = 0;
+	}
+
+	void AnimationLibrary::loadBlueprint(const BlueprintData& blueprint)
+	{
+		for (uint32_t type = 0; type < AnimationType::COUNT; ++type)
+		{
+			const std::string* value = blueprint.find(std::string{ "Animation." } + animationNames[type]);
+			if (value == nullptr)
+			{
+				continue;
+			}
+
+			std::istringstream words{ *value };
+			float framesPerSecond = 0.0f;
+			std::string mode;
+			std::vector<std::string> frames;
+			words >> framesPerSecond >> mode;
+			for (std::string frame; words >> frame;)
+			{
+				frames.push_back(frame);
+			}
+			if (mode != "loop" && mode != "once")
+			{
+				throw std::runtime_error{ "Animation." + std::string{ animationNames[type] } + " of " + blueprint.name + " has to be loop or once" };
+			}
+			addClip(blueprint.name, (AnimationType::ENUM)type, frames, framesPerSecond, mode == "loop");
+		}
+	}
+
+	uint32_t AnimationLibrary::getClip(uint32_t clipSet, AnimationType::ENUM type) const
+	{
+		return clipSet < this->clipSets.size() ? this->clipSets[clipSet][type] : NO_CLIP;
+	}
+
+	const AnimationClip& AnimationLibrary::getClipData(uint32_t clip) const
+	{
+		return this->clips[clip];
+	}
+
+	bool AnimationLibrary::play(AnimationComponent& animation, AnimationType::ENUM type, float now) const
+	{
+		uint32_t clip = getClip(animation.clipSet, type);
+		if (clip == NO_CLIP)
+		{
+			return false;
+		}
+
+		animation.clip = clip;
+		animation.startTime = now;
+		return true;
+	}
+
+	uint32_t AnimationLibrary::getFrame(uint32_t clip, float startTime, float now) const
+	{
+		const AnimationClip& data = this->clips[clip];
+		uint32_t frame = (uint32_t)std::max((now - startTime) / data.frameDuration, 0.0f);
+		frame = data.loop ? frame % data.frameCount : std::min(frame, data.frameCount - 1);
+		return data.firstFrame + frame;
+	}
+
+	const std::string& AnimationLibrary::getFrameName(uint32_t frame) const
+	{
+		return this->frameNames[frame];
+	}
+
+	void AnimationLibrary::update(EntityManager& entityManager, ThreadPool& threadPool, const std::vector<uint32_t>& entities
+		, const std::vector<uint32_t>& refresh, float now, float delta)
+	{
+		this->changes.resize(entities.size());
+		// Workers only read components and write their own entries
+		threadPool.parallelFor((uint32_t)entities.size(), 512, [&](uint32_t begin, uint32_t end, uint32_t)
+		{
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				FrameChange& change = this->changes[i];
+				change.frame = NO_FRAME;
+
+				auto animation = entityManager.getComponent<AnimationComponent>(entities[i]);
+				if (animation == nullptr || animation->clip == NO_CLIP)
+				{
+					continue;
+				}
+				auto graphics = entityManager.getComponent<GraphicsComponent>(entities[i]);
+				if (graphics == nullptr || graphics->node == nullptr || !graphics->visible)
+				{
+					continue;
+				}
+
+				uint32_t frame = getFrame(animation->clip, animation->startTime, now);
+				bool started = animation->startTime > now - delta;
+				if (started || frame != getFrame(animation->clip, animation->startTime, now - delta)
+					|| std::binary_search(refresh.begin(), refresh.end(), entities[i]))
+				{
+					change.node = graphics->node;
+					change.frame = frame;
+				}
+			}
+		});
+
+		// The scene graph is only touched from this thread
+		for (const auto& change : this->changes)
+		{
+			if (change.frame != NO_FRAME)
+			{
+				static_cast<Sprite*>(change.node)->setSpriteFrame(this->frameNames[change.frame]);
+			}
+		}
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
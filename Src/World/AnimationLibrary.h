@@ -0,0 +1,97 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Components.h"
+#include "Enums.h"
+#include "2d/CCNode.h"
+
+namespace RioGame
+{
+
+	using ::RioEngine::Node;
+
+	class EntityManager;
+	class ThreadPool;
+	struct BlueprintData;
+	struct AnimationComponent;
+
+	// Frames of one animation, shared by all entities of a blueprint
+	struct AnimationClip
+	{
+		// Index of the first frame in the library's frame names
+		uint32_t firstFrame;
+		uint32_t frameCount;
+		float frameDuration;
+		bool loop;
+	};
+
+	// Animation clips of all blueprints and their playback
+	// An entity only stores its clip set (the clips of its blueprint), the playing clip and the time
+	// the clip started, the frame to show is computed from the time, so entities that weren't
+	// updated for a while (off screen) show the right frame as soon as they are updated again
+	// Clips are defined in blueprint data, one property per animation type:
+	//
+	// Animation.WALK 12 loop orc_walk_0.png orc_walk_1.png orc_walk_2.png
+	// Animation.HIT 20 once orc_hit_0.png orc_hit_1.png
+	//
+	// (frames per second, loop or once, sprite frame names)
+	class AnimationLibrary
+	{
+	public:
+		// The AnimationComponent stores the ids, so it owns the sentinel
+		static constexpr uint32_t NO_CLIP = AnimationComponent::NO_CLIP;
+
+		AnimationLibrary() = default;
+		AnimationLibrary(const AnimationLibrary&) = delete;
+		AnimationLibrary& operator=(const AnimationLibrary&) = delete;
+
+		// Returns the id of the blueprint's clip set, creating an empty one if needed
+		uint32_t getClipSet(const std::string& blueprint);
+		// Defines (or redefines) the clip of an animation type in the blueprint's clip set, returns the clip id
+		uint32_t addClip(const std::string& blueprint, AnimationType::ENUM type
+			, const std::vector<std::string>& frames, float framesPerSecond, bool loop);
+		// Defines the clips given by the "Animation.<TYPE>" properties of the blueprint, throws std::runtime_error on malformed values
+		void loadBlueprint(const BlueprintData& blueprint);
+
+		// Returns the clip of the animation type in the clip set or NO_CLIP
+		uint32_t getClip(uint32_t clipSet, AnimationType::ENUM type) const;
+		const AnimationClip& getClipData(uint32_t clip) const;
+		// Starts the animation of the given type at time now, returns false if the clip set has no such clip
+		bool play(AnimationComponent& animation, AnimationType::ENUM type, float now) const;
+		// Index (into the frame names) of the frame shown at time now
+		uint32_t getFrame(uint32_t clip, float startTime, float now) const;
+		const std::string& getFrameName(uint32_t frame) const;
+
+		// Sets the sprite frames of the given entities to the frames of time now, frames are computed
+		// in parallel and only the sprites whose frame changed since now - delta (or that are in
+		// refresh, both sorted by id) are touched. Nodes of animated entities have to be Sprites
+		void update(EntityManager& entityManager, ThreadPool& threadPool, const std::vector<uint32_t>& entities
+			, const std::vector<uint32_t>& refresh, float now, float delta);
+	private:
+		struct FrameChange
+		{
+			Node* node;
+			uint32_t frame;
+		};
+
+		// Drops the frame names no clip uses anymore
+		void compactFrames();
+
+		std::vector<AnimationClip> clips;
+		std::vector<std::string> frameNames;
+		// Frame names left behind by redefined clips
+		uint32_t unusedFrames = 0;
+		std::vector<std::array<uint32_t, AnimationType::COUNT>> clipSets;
+		std::unordered_map<std::string, uint32_t> clipSetIds;
+		// One entry per updated entity, reused every tick
+		std::vector<FrameChange> changes;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
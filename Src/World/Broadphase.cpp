@@ -0,0 +1,257 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "Broadphase.h"
+
+#include <algorithm>
+
+#include "Components.h"
+#include "EntityManager.h"
+#include "ChangeTracker.h"
+
+namespace RioGame
+{
+
+	namespace
+	{
+		const std::vector<uint32_t> noOverlaps;
+
+		void sortUnique(ArenaVector<uint32_t>& entities)
+		{
+			std::sort(entities.begin(), entities.end());
+			entities.erase(std::unique(entities.begin(), entities.end()), entities.end());
+		}
+
+		void eraseValue(std::vector<uint32_t>& entities, uint32_t value)
+		{
+			auto it = std::find(entities.begin(), entities.end(), value);
+			if (it != entities.end())
+			{
+				*it = entities.back();
+				entities.pop_back();
+			}
+		}
+	}
+
+	Broadphase::Broadphase(EntityManager& entityManager, ChangeTracker& changes, const SpatialGrid& positions, LinearArena& frameArena)
+		: entityManager{ entityManager }
+		, changes{ changes }
+		, positions{ positions }
+		, frameArena{ frameArena }
+	{
+		this->physicsSubscription = changes.subscribe(PhysicsComponent::type, (uint8_t)ChangeKind::ALL);
+		this->triggerSubscription = changes.subscribe(TriggerComponent::type, (uint8_t)ChangeKind::ALL);
+		this->eventSubscription = changes.subscribe(EventComponent::type, (uint8_t)ChangeKind::ALL);
+	}
+
+	Broadphase::~Broadphase()
+	{
+		this->changes.unsubscribe(this->physicsSubscription);
+		this->changes.unsubscribe(this->triggerSubscription);
+		this->changes.unsubscribe(this->eventSubscription);
+	}
+
+	void Broadphase::process()
+	{
+		// The events are read after the frame arena's reset, they keep their own storage
+		this->events.clear();
+		// The work lists of the last tick went with the frame arena's reset
+		this->dirtySensors = ArenaVector<uint32_t>{ ArenaAllocator<uint32_t>{ &this->frameArena } };
+		this->dirtyEntities = ArenaVector<uint32_t>{ ArenaAllocator<uint32_t>{ &this->frameArena } };
+		this->found = ArenaVector<uint32_t>{ ArenaAllocator<uint32_t>{ &this->frameArena } };
+
+		this->changes.forEachChange(this->physicsSubscription, [this](uint32_t entity, ChangeKind)
+		{
+			this->dirtyEntities.push_back(entity);
+			// A sensor that moved is a sensor that changed
+			if (this->sensors.count(entity) != 0)
+			{
+				this->dirtySensors.push_back(entity);
+			}
+		});
+		auto sensorChanged = [this](uint32_t entity, ChangeKind)
+		{
+			this->dirtySensors.push_back(entity);
+		};
+		this->changes.forEachChange(this->triggerSubscription, sensorChanged);
+		this->changes.forEachChange(this->eventSubscription, sensorChanged);
+		sortUnique(this->dirtySensors);
+		sortUnique(this->dirtyEntities);
+
+		// Sensors first, so the entities are tested against the sensors' new positions
+		for (uint32_t sensor : this->dirtySensors)
+		{
+			updateSensor(sensor);
+		}
+		for (uint32_t entity : this->dirtyEntities)
+		{
+			updateEntity(entity);
+		}
+	}
+
+	const std::vector<Broadphase::Overlap>& Broadphase::getEvents() const
+	{
+		return this->events;
+	}
+
+	const std::vector<uint32_t>& Broadphase::getOverlaps(uint32_t sensor) const
+	{
+		auto it = this->sensorOverlaps.find(sensor);
+		return it != this->sensorOverlaps.end() ? it->second : noOverlaps;
+	}
+
+	bool Broadphase::isOverlapping(uint32_t sensor, uint32_t entity) const
+	{
+		const auto& overlaps = getOverlaps(sensor);
+		return std::find(overlaps.begin(), overlaps.end(), entity) != overlaps.end();
+	}
+
+	uint32_t Broadphase::getSensorCount() const
+	{
+		return (uint32_t)this->sensors.size();
+	}
+
+	void Broadphase::clear()
+	{
+		this->sensorGrid.clear();
+		this->sensors.clear();
+		this->maxRadius = 0.0f;
+		this->sensorOverlaps.clear();
+		this->entityOverlaps.clear();
+		this->events.clear();
+	}
+
+	bool Broadphase::getSensor(uint32_t entity, Sensor& sensor) const
+	{
+		auto physics = this->entityManager.getComponent<PhysicsComponent>(entity);
+		if (physics == nullptr)
+		{
+			return false;
+		}
+
+		sensor.position = physics->position;
+		sensor.radius = 0.0f;
+		auto trigger = this->entityManager.getComponent<TriggerComponent>(entity);
+		if (trigger != nullptr)
+		{
+			sensor.radius = trigger->radius;
+		}
+		auto event = this->entityManager.getComponent<EventComponent>(entity);
+		if (event != nullptr && event->active)
+		{
+			sensor.radius = std::max(sensor.radius, event->radius);
+		}
+		return sensor.radius > 0.0f;
+	}
+
+	void Broadphase::updateSensor(uint32_t sensor)
+	{
+		Sensor data;
+		bool isSensor = getSensor(sensor, data);
+		this->found.clear();
+		if (isSensor)
+		{
+			this->sensors[sensor] = data;
+			this->sensorGrid.insert(sensor, data.position);
+			this->maxRadius = std::max(this->maxRadius, data.radius);
+			this->positions.forEachInRadius(data.position, data.radius, [this, sensor](uint32_t entity, const Vec2&)
+			{
+				if (entity != sensor)
+				{
+					this->found.push_back(entity);
+				}
+			});
+			std::sort(this->found.begin(), this->found.end());
+		}
+		else
+		{
+			this->sensors.erase(sensor);
+			this->sensorGrid.remove(sensor);
+		}
+
+		// Copy, begin and end change the sensor's overlaps
+		std::vector<uint32_t> previous = getOverlaps(sensor);
+		std::sort(previous.begin(), previous.end());
+		uint32_t i = 0;
+		uint32_t j = 0;
+		while (i < previous.size() || j < this->found.size())
+		{
+			if (j == this->found.size() || (i < previous.size() && previous[i] < this->found[j]))
+			{
+				end(sensor, previous[i++]);
+			}
+			else if (i == previous.size() || this->found[j] < previous[i])
+			{
+				begin(sensor, this->found[j++]);
+			}
+			else
+			{
+				++i;
+				++j;
+			}
+		}
+		if (!isSensor)
+		{
+			this->sensorOverlaps.erase(sensor);
+		}
+	}
+
+	void Broadphase::updateEntity(uint32_t entity)
+	{
+		auto physics = this->entityManager.getComponent<PhysicsComponent>(entity);
+		this->found.clear();
+		if (physics != nullptr)
+		{
+			// Sensors are searched within the largest radius and filtered by their own
+			this->sensorGrid.forEachInRadius(physics->position, this->maxRadius, [this, entity, physics](uint32_t sensor, const Vec2& center)
+			{
+				float radius = this->sensors[sensor].radius;
+				float dx = physics->position.x - center.x;
+				float dy = physics->position.y - center.y;
+				if (sensor != entity && dx * dx + dy * dy <= radius * radius)
+				{
+					this->found.push_back(sensor);
+				}
+			});
+		}
+
+		auto it = this->entityOverlaps.find(entity);
+		std::vector<uint32_t> previous = it != this->entityOverlaps.end() ? it->second : noOverlaps;
+		for (uint32_t sensor : previous)
+		{
+			if (std::find(this->found.begin(), this->found.end(), sensor) == this->found.end())
+			{
+				end(sensor, entity);
+			}
+		}
+		for (uint32_t sensor : this->found)
+		{
+			if (std::find(previous.begin(), previous.end(), sensor) == previous.end())
+			{
+				begin(sensor, entity);
+			}
+		}
+	}
+
+	void Broadphase::begin(uint32_t sensor, uint32_t entity)
+	{
+		this->sensorOverlaps[sensor].push_back(entity);
+		this->entityOverlaps[entity].push_back(sensor);
+		this->events.push_back(Overlap{ sensor, entity, true });
+	}
+
+	void Broadphase::end(uint32_t sensor, uint32_t entity)
+	{
+		eraseValue(this->sensorOverlaps[sensor], entity);
+		auto it = this->entityOverlaps.find(entity);
+		if (it != this->entityOverlaps.end())
+		{
+			eraseValue(it->second, sensor);
+			if (it->second.empty())
+			{
+				this->entityOverlaps.erase(it);
+			}
+		}
+		this->events.push_back(Overlap{ sensor, entity, false });
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
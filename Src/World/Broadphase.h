@@ -0,0 +1,92 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "math/Vec2.h"
+
+#include "SpatialGrid.h"
+#include "Tools/LinearArena.h"
+
+namespace RioGame
+{
+
+	using ::RioEngine::Vec2;
+
+	class EntityManager;
+	class ChangeTracker;
+
+	// Persistent overlaps of sensors (entities with a TriggerComponent or an active EventComponent
+	// and a radius) with the positions of all other entities
+	// Overlaps are only recomputed for what changed in a tick: a sensor that moved, was added or
+	// changed its radius is queried against the VisibilityIndex's grid of all positions, an entity
+	// that moved is queried against a grid of the sensors. The result is a list of begin and end
+	// events, so the TriggerSystem reacts to entities entering and leaving instead of scanning
+	// Has to be processed after the VisibilityIndex, whose grid it reads
+	// Moving means a reported PhysicsComponent change (the World reports the units the MovementSystem
+	// moved, anything else is moved with World::setPosition), an unreported move doesn't begin or end overlaps
+	// The work lists of a tick live in the frame arena, the events stay valid until the next process call
+	class Broadphase
+	{
+	public:
+		struct Overlap
+		{
+			uint32_t sensor;
+			uint32_t entity;
+			// True when the entity entered the sensor's radius, false when it left (or one of them is gone)
+			bool begin;
+		};
+
+		Broadphase(EntityManager& entityManager, ChangeTracker& changes, const SpatialGrid& positions, LinearArena& frameArena);
+		Broadphase(const Broadphase&) = delete;
+		Broadphase& operator=(const Broadphase&) = delete;
+		~Broadphase();
+
+		void process();
+		// Overlaps that began or ended in the last process call
+		const std::vector<Overlap>& getEvents() const;
+		// Entities currently inside the sensor's radius
+		const std::vector<uint32_t>& getOverlaps(uint32_t sensor) const;
+		bool isOverlapping(uint32_t sensor, uint32_t entity) const;
+		uint32_t getSensorCount() const;
+		void clear();
+	private:
+		struct Sensor
+		{
+			Vec2 position;
+			float radius;
+		};
+
+		// Returns false if the entity isn't a sensor (anymore)
+		bool getSensor(uint32_t entity, Sensor& sensor) const;
+		void updateSensor(uint32_t sensor);
+		void updateEntity(uint32_t entity);
+		void begin(uint32_t sensor, uint32_t entity);
+		void end(uint32_t sensor, uint32_t entity);
+
+		EntityManager& entityManager;
+		ChangeTracker& changes;
+		const SpatialGrid& positions;
+		LinearArena& frameArena;
+		uint32_t physicsSubscription;
+		uint32_t triggerSubscription;
+		uint32_t eventSubscription;
+
+		SpatialGrid sensorGrid;
+		std::unordered_map<uint32_t, Sensor> sensors;
+		// Largest radius of all sensors ever added, bounds the search for an entity's sensors
+		float maxRadius = 0.0f;
+		// Both directions of every overlap
+		std::unordered_map<uint32_t, std::vector<uint32_t>> sensorOverlaps;
+		std::unordered_map<uint32_t, std::vector<uint32_t>> entityOverlaps;
+
+		ArenaVector<uint32_t> dirtySensors;
+		ArenaVector<uint32_t> dirtyEntities;
+		ArenaVector<uint32_t> found;
+		std::vector<Overlap> events;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
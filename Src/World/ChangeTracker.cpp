@@ -0,0 +1,155 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "ChangeTracker.h"
+
+#include <algorithm>
+
+namespace RioGame
+{
+
+	ChangeTracker::ChangeTracker()
+		: types(Component::count)
+	{
+	}
+
+	void ChangeTracker::nextTick()
+	{
+		++this->tick;
+		for (auto& typeLog : this->types)
+		{
+			typeLog.tickKinds.clear();
+		}
+	}
+
+	uint32_t ChangeTracker::getTick() const
+	{
+		return this->tick;
+	}
+
+	void ChangeTracker::mark(uint32_t entity, uint32_t type, ChangeKind kind)
+	{
+		TypeLog& typeLog = this->types[type];
+		// Nobody reads anything of an unwatched type, marking it is a single check
+		if (!isWatched(typeLog))
+		{
+			return;
+		}
+
+		uint8_t& logged = typeLog.tickKinds[entity];
+		if (logged & (uint8_t)kind)
+		{
+			return;
+		}
+		logged |= (uint8_t)kind;
+
+		if (kind == ChangeKind::REMOVED)
+		{
+			typeLog.lastChanged.erase(entity);
+		}
+		else
+		{
+			typeLog.lastChanged[entity] = this->tick;
+		}
+		typeLog.log.push_back(Change{ entity, this->tick, kind });
+	}
+
+	uint32_t ChangeTracker::getLastChanged(uint32_t entity, uint32_t type) const
+	{
+		const auto& lastChanged = this->types[type].lastChanged;
+		auto it = lastChanged.find(entity);
+		return it != lastChanged.end() ? it->second : 0;
+	}
+
+	uint32_t ChangeTracker::subscribe(uint32_t type, uint8_t kinds)
+	{
+		TypeLog& typeLog = this->types[type];
+		++typeLog.subscriberCount;
+		this->subscribers.push_back(Subscriber{ type, kinds, typeLog.first + (uint32_t)typeLog.log.size(), true });
+		return (uint32_t)this->subscribers.size() - 1;
+	}
+
+	void ChangeTracker::unsubscribe(uint32_t subscription)
+	{
+		Subscriber& subscriber = this->subscribers[subscription];
+		if (subscriber.active)
+		{
+			subscriber.active = false;
+			--this->types[subscriber.type].subscriberCount;
+		}
+	}
+
+	void ChangeTracker::observe(uint32_t type, uint8_t kinds, const Observer& observer)
+	{
+		TypeLog& typeLog = this->types[type];
+		if (typeLog.observers.empty())
+		{
+			// Changes logged before the first observer existed aren't dispatched to it
+			typeLog.dispatched = typeLog.first + (uint32_t)typeLog.log.size();
+		}
+		typeLog.observers.push_back(ObserverEntry{ kinds, observer });
+	}
+
+	void ChangeTracker::dispatch()
+	{
+		for (uint32_t type = 0; type < this->types.size(); ++type)
+		{
+			TypeLog& typeLog = this->types[type];
+			uint32_t end = typeLog.first + (uint32_t)typeLog.log.size();
+			// Observers may mark new changes, those are dispatched with the next tick
+			for (uint32_t i = typeLog.dispatched; i < end; ++i)
+			{
+				Change change = typeLog.log[i - typeLog.first];
+				for (auto& entry : typeLog.observers)
+				{
+					if (entry.kinds & (uint8_t)change.kind)
+					{
+						entry.observer(change.entity, change.kind);
+					}
+				}
+			}
+			typeLog.dispatched = end;
+			trim(typeLog, type);
+		}
+	}
+
+	void ChangeTracker::clear()
+	{
+		for (auto& typeLog : this->types)
+		{
+			typeLog.first += (uint32_t)typeLog.log.size();
+			typeLog.dispatched = typeLog.first;
+			typeLog.log.clear();
+			typeLog.lastChanged.clear();
+			typeLog.tickKinds.clear();
+		}
+		for (auto& subscriber : this->subscribers)
+		{
+			subscriber.cursor = this->types[subscriber.type].first;
+		}
+	}
+
+	void ChangeTracker::trim(TypeLog& typeLog, uint32_t type)
+	{
+		uint32_t end = typeLog.first + (uint32_t)typeLog.log.size();
+		uint32_t keepFrom = typeLog.observers.empty() ? end : typeLog.dispatched;
+		for (const auto& subscriber : this->subscribers)
+		{
+			if (subscriber.active && subscriber.type == type)
+			{
+				keepFrom = std::min(keepFrom, subscriber.cursor);
+			}
+		}
+
+		if (keepFrom > typeLog.first)
+		{
+			typeLog.log.erase(typeLog.log.begin(), typeLog.log.begin() + (keepFrom - typeLog.first));
+			typeLog.first = keepFrom;
+		}
+	}
+
+	bool ChangeTracker::isWatched(const TypeLog& typeLog) const
+	{
+		return typeLog.subscriberCount > 0 || !typeLog.observers.empty();
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,139 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "Components.h"
+
+namespace RioGame
+{
+
+	enum class ChangeKind : uint8_t
+	{
+		ADDED = 1 << 0,
+		CHANGED = 1 << 1,
+		REMOVED = 1 << 2,
+		ALL = ADDED | CHANGED | REMOVED
+	};
+
+	// Records which components were added, changed or removed in which tick, so that systems
+	// only look at the entities that changed instead of scanning all of them
+	// Every watched component type has a log of changes, an entity is logged at most once per kind and tick
+	// Changes of types nobody subscribed to or observes are dropped right away
+	// Subscribers read the log from where they stopped (pull), observers are called with the
+	// changes of the tick by dispatch (push), log entries all subscribers have read are dropped
+	class ChangeTracker
+	{
+	public:
+		struct Change
+		{
+			uint32_t entity;
+			uint32_t tick;
+			ChangeKind kind;
+		};
+
+		using Observer = std::function<void(uint32_t entity, ChangeKind kind)>;
+
+		ChangeTracker();
+		ChangeTracker(const ChangeTracker&) = delete;
+		ChangeTracker& operator=(const ChangeTracker&) = delete;
+
+		// Starts the next tick (called by the World at the start of every tick)
+		void nextTick();
+		uint32_t getTick() const;
+
+		void mark(uint32_t entity, uint32_t type, ChangeKind kind);
+
+		template<typename T>
+		void markAdded(uint32_t entity)
+		{
+			mark(entity, T::type, ChangeKind::ADDED);
+		}
+
+		template<typename T>
+		void markChanged(uint32_t entity)
+		{
+			mark(entity, T::type, ChangeKind::CHANGED);
+		}
+
+		template<typename T>
+		void markRemoved(uint32_t entity)
+		{
+			mark(entity, T::type, ChangeKind::REMOVED);
+		}
+
+		// Returns the last tick the component of the entity was changed (or added) in, 0 if never
+		// Only tracked while the type is watched (has a subscriber or an observer)
+		uint32_t getLastChanged(uint32_t entity, uint32_t type) const;
+
+		// Returns a subscription to changes of the given kinds (ChangeKind values or-ed together) of a component type,
+		// the subscriber sees the changes made after subscribing
+		uint32_t subscribe(uint32_t type, uint8_t kinds);
+		void unsubscribe(uint32_t subscription);
+		// Calls function(entity, kind) for the changes the subscriber hasn't seen yet
+		template<typename Function>
+		void forEachChange(uint32_t subscription, Function&& function)
+		{
+			Subscriber& subscriber = this->subscribers[subscription];
+			const auto& log = this->types[subscriber.type].log;
+			uint32_t end = this->types[subscriber.type].first + (uint32_t)log.size();
+			for (uint32_t i = subscriber.cursor; i < end; ++i)
+			{
+				const Change& change = log[i - this->types[subscriber.type].first];
+				if (subscriber.kinds & (uint8_t)change.kind)
+				{
+					function(change.entity, change.kind);
+				}
+			}
+			subscriber.cursor = end;
+		}
+
+		// Calls the observer with every change of the given kinds made in a tick, when the tick gets dispatched
+		void observe(uint32_t type, uint8_t kinds, const Observer& observer);
+		// Calls the observers with the changes of the current tick and trims the logs (called by the World at the end of every tick)
+		void dispatch();
+		void clear();
+	private:
+		struct Subscriber
+		{
+			uint32_t type;
+			uint8_t kinds;
+			// Absolute position in the log of the type
+			uint32_t cursor;
+			bool active;
+		};
+
+		struct ObserverEntry
+		{
+			uint8_t kinds;
+			Observer observer;
+		};
+
+		struct TypeLog
+		{
+			std::vector<Change> log;
+			// Absolute position of log[0], positions stay valid when the front of the log gets dropped
+			uint32_t first = 0;
+			// Absolute position of the first change not dispatched to the observers yet
+			uint32_t dispatched = 0;
+			// Tick of the last change (or addition) of every entity having the component
+			std::unordered_map<uint32_t, uint32_t> lastChanged;
+			// Kinds an entity was logged with in the current tick
+			std::unordered_map<uint32_t, uint8_t> tickKinds;
+			std::vector<ObserverEntry> observers;
+			uint32_t subscriberCount = 0;
+		};
+
+		void trim(TypeLog& typeLog, uint32_t type);
+		bool isWatched(const TypeLog& typeLog) const;
+
+		std::vector<TypeLog> types;
+		std::vector<Subscriber> subscribers;
+		uint32_t tick = 1;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
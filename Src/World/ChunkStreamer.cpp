@@ -0,0 +1,713 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "ChunkStreamer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "base/Macros.h" // for RioAssert
+
+#include "Components.h"
+#include "EntityManager.h"
+#include "World.h"
+
+namespace RioGame
+{
+
+	namespace
+	{
+		// Offsets of the neighbours in the order of the Direction enum (same as the ChunkedLevelGenerator)
+		const int32_t offsets[][2] = {
+			{ 0, 1 }, { 0, -1 }, { -1, 0 }, { 1, 0 }, { -1, 1 }, { 1, 1 }, { -1, -1 }, { 1, -1 }
+		};
+
+		const uint32_t opposite[] = {
+			Direction::DOWN, Direction::UP, Direction::RIGHT, Direction::LEFT
+			, Direction::DOWN_RIGHT, Direction::DOWN_LEFT, Direction::UP_RIGHT, Direction::UP_LEFT
+		};
+
+		// Unused bytes at the end of a record's slot, so that the record still fits after small changes
+		const uint32_t recordSlack = 16;
+
+		bool isPassable(LevelGenerators::Tile tile)
+		{
+			return tile == LevelGenerators::Tile::FREE || tile == LevelGenerators::Tile::PORTAL;
+		}
+
+		void put(std::string& data, uint32_t value, uint32_t bytes)
+		{
+			for (uint32_t i = 0; i < bytes; ++i)
+			{
+				data.push_back((char)((value >> (i * 8)) & 0xff));
+			}
+		}
+
+		uint32_t get(const std::string& data, size_t& position, uint32_t bytes)
+		{
+			uint32_t value = 0;
+			for (uint32_t i = 0; i < bytes; ++i)
+			{
+				value |= (uint32_t)(uint8_t)data[position++] << (i * 8);
+			}
+			return value;
+		}
+	}
+
+	ChunkStreamer::ChunkStreamer(World& world, const std::string& storagePath)
+		: world{ world }
+		, storagePath{ storagePath }
+	{
+	}
+
+	void ChunkStreamer::init(const LevelGenerators::ChunkedLevelGenerator& generator, float tileSize)
+	{
+		unloadAll();
+
+		this->width = generator.getWidth();
+		this->height = generator.getHeight();
+		this->tileSize = tileSize;
+		this->chunksX = (this->width + chunkSize - 1) / chunkSize;
+		this->chunksY = (this->height + chunkSize - 1) / chunkSize;
+		this->chunks.assign(this->chunksX * this->chunksY, Chunk{});
+		this->portalPartners.clear();
+		this->pagedOutGold.clear();
+		this->detours.clear();
+		this->frame = 0;
+		// Cells of paged out chunks are walls for the placement and the steps of the units
+		this->world.getOccupancyMap().resize(this->width, this->height, true);
+
+		this->storage.close();
+		this->storage.open(this->storagePath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!this->storage)
+		{
+			throw std::runtime_error{ "Could not open chunk storage " + this->storagePath };
+		}
+		this->storageEnd = 0;
+
+		const auto& tiles = generator.getTiles();
+		// Same pairing as ChunkedLevelGenerator::createEntities, in the order the portals appear in the map
+		uint32_t unpairedPortal = uint32_t(-1);
+		for (uint32_t i = 0; i < tiles.size(); ++i)
+		{
+			if (tiles[i] != Tile::PORTAL)
+			{
+				continue;
+			}
+			if (unpairedPortal == uint32_t(-1))
+			{
+				unpairedPortal = i;
+			}
+			else
+			{
+				this->portalPartners[i] = unpairedPortal;
+				this->portalPartners[unpairedPortal] = i;
+				unpairedPortal = uint32_t(-1);
+			}
+		}
+
+		uint32_t goldPerMine = generator.getSettings().goldPerMine;
+		std::vector<Tile> chunkTiles;
+		std::vector<Mine> mines;
+		for (uint32_t chunk = 0; chunk < this->chunks.size(); ++chunk)
+		{
+			uint32_t left = (chunk % this->chunksX) * chunkSize;
+			uint32_t top = (chunk / this->chunksX) * chunkSize;
+			uint32_t chunkWidth = std::min(chunkSize, this->width - left);
+			uint32_t chunkHeight = std::min(chunkSize, this->height - top);
+
+			chunkTiles.clear();
+			mines.clear();
+			for (uint32_t y = top; y < top + chunkHeight; ++y)
+			{
+				for (uint32_t x = left; x < left + chunkWidth; ++x)
+				{
+					Tile tile = tiles[y * this->width + x];
+					if (tile == Tile::GOLD_MINE)
+					{
+						mines.push_back(Mine{ (uint16_t)chunkTiles.size(), goldPerMine, goldPerMine });
+					}
+					chunkTiles.push_back(tile);
+				}
+			}
+			write(chunk, chunkTiles, mines);
+		}
+	}
+
+	void ChunkStreamer::update(const Vec2& focus)
+	{
+		++this->frame;
+
+		EntityManager& entityManager = this->world.getEntityManager();
+		std::vector<uint32_t> toLoad;
+		markNeeded(focus, toLoad);
+		for (const auto& movement : entityManager.getComponentContainer<MovementComponent>())
+		{
+			auto physics = entityManager.getComponent<PhysicsComponent>(movement.first);
+			if (physics != nullptr)
+			{
+				markNeeded(physics->position, toLoad);
+			}
+		}
+
+		// Chunks around the focus were marked first, so they get loaded first
+		uint32_t loads = std::min((uint32_t)toLoad.size(), this->maxLoadsPerUpdate);
+		for (uint32_t i = 0; i < loads; ++i)
+		{
+			load(toLoad[i]);
+		}
+
+		if (this->resident.size() <= this->maxResident)
+		{
+			return;
+		}
+
+		std::vector<uint8_t> pinned;
+		findPinned(pinned);
+		std::vector<uint32_t> candidates;
+		for (auto chunk : this->resident)
+		{
+			if (this->chunks[chunk].lastNeeded != this->frame && !pinned[chunk])
+			{
+				candidates.push_back(chunk);
+			}
+		}
+		std::sort(candidates.begin(), candidates.end(), [this](uint32_t lhs, uint32_t rhs)
+		{
+			return this->chunks[lhs].lastNeeded < this->chunks[rhs].lastNeeded;
+		});
+		for (uint32_t i = 0; i < candidates.size() && this->resident.size() > this->maxResident; ++i)
+		{
+			unload(candidates[i]);
+		}
+	}
+
+	void ChunkStreamer::unloadAll()
+	{
+		while (!this->resident.empty())
+		{
+			unload(this->resident.back());
+		}
+	}
+
+	uint32_t ChunkStreamer::drawGold(uint32_t mine, uint32_t amount)
+	{
+		auto gold = this->pagedOutGold.find(mine);
+		if (gold == this->pagedOutGold.end())
+		{
+			return 0;
+		}
+
+		uint32_t taken = std::min(amount, gold->second);
+		gold->second -= taken;
+		uint32_t x = mine % this->width;
+		uint32_t y = mine / this->width;
+		this->chunks[(y / chunkSize) * this->chunksX + x / chunkSize].summary.gold -= taken;
+		return taken;
+	}
+
+	void ChunkStreamer::setLoadHandler(const LoadHandler& handler)
+	{
+		this->loadHandler = handler;
+	}
+
+	void ChunkStreamer::setUnloadHandler(const UnloadHandler& handler)
+	{
+		this->unloadHandler = handler;
+	}
+
+	void ChunkStreamer::setResidencyRadius(uint32_t radius)
+	{
+		this->radius = radius;
+	}
+
+	void ChunkStreamer::setMaxResident(uint32_t maxResident)
+	{
+		this->maxResident = maxResident;
+	}
+
+	void ChunkStreamer::setMaxLoadsPerUpdate(uint32_t maxLoads)
+	{
+		this->maxLoadsPerUpdate = maxLoads;
+	}
+
+	uint32_t ChunkStreamer::getNode(uint32_t x, uint32_t y) const
+	{
+		const Chunk& chunk = this->chunks[(y / chunkSize) * this->chunksX + x / chunkSize];
+		if (!chunk.resident)
+		{
+			return Component::NO_ENTITY;
+		}
+
+		uint32_t left = (x / chunkSize) * chunkSize;
+		uint32_t chunkWidth = std::min(chunkSize, this->width - left);
+		return chunk.nodes[(y % chunkSize) * chunkWidth + (x - left)];
+	}
+
+	uint32_t ChunkStreamer::getChunk(const Vec2& position) const
+	{
+		RioAssert(!this->chunks.empty(), "ChunkStreamer not initialized");
+		float x = std::max(position.x / this->tileSize + 0.5f, 0.0f);
+		float y = std::max(position.y / this->tileSize + 0.5f, 0.0f);
+		uint32_t chunkX = std::min((uint32_t)x / chunkSize, this->chunksX - 1);
+		uint32_t chunkY = std::min((uint32_t)y / chunkSize, this->chunksY - 1);
+		return chunkY * this->chunksX + chunkX;
+	}
+
+	bool ChunkStreamer::isResident(uint32_t chunk) const
+	{
+		return this->chunks[chunk].resident;
+	}
+
+	const ChunkSummary& ChunkStreamer::getSummary(uint32_t chunk) const
+	{
+		return this->chunks[chunk].summary;
+	}
+
+	uint32_t ChunkStreamer::getChunkCount() const
+	{
+		return (uint32_t)this->chunks.size();
+	}
+
+	uint32_t ChunkStreamer::getResidentCount() const
+	{
+		return (uint32_t)this->resident.size();
+	}
+
+	void ChunkStreamer::write(uint32_t chunk, const std::vector<Tile>& tiles, const std::vector<Mine>& mines)
+	{
+		// Record: runs of (length, tile), mine count, (tile, gold, max gold) per mine
+		std::string data;
+		for (uint32_t i = 0; i < tiles.size();)
+		{
+			uint32_t run = 1;
+			while (i + run < tiles.size() && run < 255 && tiles[i + run] == tiles[i])
+			{
+				++run;
+			}
+			put(data, run, 1);
+			put(data, (uint32_t)tiles[i], 1);
+			i += run;
+		}
+		put(data, (uint32_t)mines.size(), 2);
+		for (const auto& mine : mines)
+		{
+			put(data, mine.tile, 2);
+			put(data, mine.gold, 4);
+			put(data, mine.maxGold, 4);
+		}
+
+		// The record is written over the old one if it fits, otherwise it gets a new slot at the end
+		// (a chunk's record only shrinks or grows by a few bytes when its mines get exhausted)
+		Chunk& record = this->chunks[chunk];
+		record.size = (uint32_t)data.size();
+		if (record.size > record.capacity)
+		{
+			record.offset = this->storageEnd;
+			record.capacity = record.size + recordSlack;
+			this->storageEnd += record.capacity;
+			data.resize(record.capacity, '\0');
+		}
+		this->storage.seekp((std::streamoff)record.offset);
+		this->storage.write(data.data(), data.size());
+		if (!this->storage)
+		{
+			throw std::runtime_error{ "Could not write chunk storage " + this->storagePath };
+		}
+
+		ChunkSummary& summary = record.summary;
+		summary.gold = 0;
+		summary.freeTiles = 0;
+		summary.portals = 0;
+		summary.mines = (uint16_t)mines.size();
+		for (const auto& mine : mines)
+		{
+			summary.gold += mine.gold;
+		}
+		for (auto tile : tiles)
+		{
+			summary.freeTiles += tile == Tile::FREE;
+			summary.portals += tile == Tile::PORTAL;
+		}
+	}
+
+	void ChunkStreamer::read(uint32_t chunk, std::vector<Tile>& tiles, std::vector<Mine>& mines)
+	{
+		const Chunk& record = this->chunks[chunk];
+		std::string data(record.size, '\0');
+		this->storage.seekg((std::streamoff)record.offset);
+		this->storage.read(&data[0], data.size());
+		if (!this->storage)
+		{
+			throw std::runtime_error{ "Could not read chunk storage " + this->storagePath };
+		}
+
+		uint32_t left = (chunk % this->chunksX) * chunkSize;
+		uint32_t top = (chunk / this->chunksX) * chunkSize;
+		size_t tileCount = std::min(chunkSize, this->width - left) * std::min(chunkSize, this->height - top);
+
+		size_t position = 0;
+		tiles.clear();
+		while (tiles.size() < tileCount)
+		{
+			uint32_t run = get(data, position, 1);
+			Tile tile = (Tile)get(data, position, 1);
+			tiles.insert(tiles.end(), run, tile);
+		}
+
+		mines.resize(get(data, position, 2));
+		for (auto& mine : mines)
+		{
+			mine.tile = (uint16_t)get(data, position, 2);
+			mine.gold = get(data, position, 4);
+			mine.maxGold = get(data, position, 4);
+		}
+	}
+
+	void ChunkStreamer::load(uint32_t index)
+	{
+		EntityManager& entityManager = this->world.getEntityManager();
+		Chunk& chunk = this->chunks[index];
+		std::vector<Mine> mines;
+		read(index, chunk.tiles, mines);
+
+		uint32_t left = (index % this->chunksX) * chunkSize;
+		uint32_t top = (index / this->chunksX) * chunkSize;
+		uint32_t chunkWidth = std::min(chunkSize, this->width - left);
+		uint32_t chunkHeight = std::min(chunkSize, this->height - top);
+
+		chunk.nodes.resize(chunk.tiles.size());
+		for (auto& node : chunk.nodes)
+		{
+			node = entityManager.createEntity();
+		}
+		chunk.resident = true;
+		chunk.lastNeeded = this->frame;
+		this->resident.push_back(index);
+
+		std::vector<uint32_t> residents(chunk.tiles.size(), Component::NO_ENTITY);
+		for (auto& mine : mines)
+		{
+			uint32_t x = left + mine.tile % chunkWidth;
+			uint32_t y = top + mine.tile / chunkWidth;
+			// Parked miners kept mining it while it was paged out
+			auto drawn = this->pagedOutGold.find(y * this->width + x);
+			if (drawn != this->pagedOutGold.end())
+			{
+				mine.gold = drawn->second;
+				this->pagedOutGold.erase(drawn);
+			}
+
+			uint32_t entity = entityManager.createEntity();
+			this->world.addComponent<MineComponent>(entity, MineComponent{});
+			this->world.addComponent<GoldComponent>(entity, GoldComponent{ mine.maxGold, mine.gold });
+			this->world.addComponent<PhysicsComponent>(entity, PhysicsComponent{ true, getTilePosition(x, y) });
+			this->world.getEconomyModel().pageInMine(y * this->width + x, entity);
+			chunk.mines.emplace_back(mine.tile, entity);
+			residents[mine.tile] = entity;
+		}
+
+		for (uint32_t local = 0; local < chunk.tiles.size(); ++local)
+		{
+			uint32_t x = left + local % chunkWidth;
+			uint32_t y = top + local / chunkWidth;
+			GridNodeComponent node{};
+			node.x = x;
+			node.y = y;
+			node.free = isPassable(chunk.tiles[local]);
+			node.resident = residents[local];
+
+			for (uint32_t direction = Direction::UP; direction < Direction::PORTAL; ++direction)
+			{
+				int32_t nx = (int32_t)x + offsets[direction][0];
+				int32_t ny = (int32_t)y + offsets[direction][1];
+				if (nx < 0 || ny < 0 || nx >= (int32_t)this->width || ny >= (int32_t)this->height)
+				{
+					continue;
+				}
+
+				uint32_t neighbour = getNode(nx, ny);
+				node.neighbours[direction] = neighbour;
+				bool outside = nx < (int32_t)left || ny < (int32_t)top
+					|| nx >= (int32_t)(left + chunkWidth) || ny >= (int32_t)(top + chunkHeight);
+				if (outside && neighbour != Component::NO_ENTITY)
+				{
+					// Links the already resident neighbour chunk back to this one
+					entityManager.getComponent<GridNodeComponent>(neighbour)->neighbours[opposite[direction]] = chunk.nodes[local];
+					this->world.getChangeTracker().markChanged<GridNodeComponent>(neighbour);
+				}
+			}
+			this->world.addComponent<GridNodeComponent>(chunk.nodes[local], node);
+		}
+
+		OccupancyMap& occupancy = this->world.getOccupancyMap();
+		for (uint32_t local = 0; local < chunk.tiles.size(); ++local)
+		{
+			uint32_t x = left + local % chunkWidth;
+			uint32_t y = top + local / chunkWidth;
+			occupancy.setWall(x, y, !isPassable(chunk.tiles[local]));
+			if (residents[local] != Component::NO_ENTITY)
+			{
+				occupancy.occupy(x, y);
+			}
+		}
+
+		for (uint32_t local = 0; local < chunk.tiles.size(); ++local)
+		{
+			if (chunk.tiles[local] != Tile::PORTAL)
+			{
+				continue;
+			}
+
+			uint32_t x = left + local % chunkWidth;
+			uint32_t y = top + local / chunkWidth;
+			uint32_t portal = entityManager.createEntity();
+			this->world.addComponent<PortalComponent>(portal, PortalComponent{});
+			this->world.addComponent<PhysicsComponent>(portal, PhysicsComponent{ false, getTilePosition(x, y) });
+			chunk.portals.push_back(portal);
+
+			auto partner = this->portalPartners.find(y * this->width + x);
+			if (partner == this->portalPartners.end())
+			{
+				continue;
+			}
+			uint32_t partnerNode = getNode(partner->second % this->width, partner->second / this->width);
+			if (partnerNode != Component::NO_ENTITY)
+			{
+				entityManager.getComponent<GridNodeComponent>(chunk.nodes[local])->neighbours[Direction::PORTAL] = partnerNode;
+				entityManager.getComponent<GridNodeComponent>(partnerNode)->neighbours[Direction::PORTAL] = chunk.nodes[local];
+				this->world.getChangeTracker().markChanged<GridNodeComponent>(partnerNode);
+			}
+		}
+
+		// Paths cut short by the unload of this chunk go on to their target
+		for (auto it = this->detours.begin(); it != this->detours.end();)
+		{
+			uint32_t x = it->second.tile % this->width;
+			uint32_t y = it->second.tile / this->width;
+			if ((y / chunkSize) * this->chunksX + x / chunkSize != index)
+			{
+				++it;
+				continue;
+			}
+
+			// Unless the entity went somewhere else in the meantime
+			auto path = entityManager.getComponent<PathfindingComponent>(it->first);
+			if (path != nullptr && path->targetId == it->second.standIn)
+			{
+				this->world.getPathRequestQueue().request(it->first, path->lastId, getNode(x, y));
+			}
+			it = this->detours.erase(it);
+		}
+
+		if (this->loadHandler)
+		{
+			this->loadHandler(index);
+		}
+	}
+
+	void ChunkStreamer::unload(uint32_t index)
+	{
+		if (this->unloadHandler)
+		{
+			this->unloadHandler(index);
+		}
+
+		cutPaths(index);
+
+		EntityManager& entityManager = this->world.getEntityManager();
+		Chunk& chunk = this->chunks[index];
+		uint32_t left = (index % this->chunksX) * chunkSize;
+		uint32_t top = (index / this->chunksX) * chunkSize;
+		uint32_t chunkWidth = std::min(chunkSize, this->width - left);
+		uint32_t chunkHeight = std::min(chunkSize, this->height - top);
+		std::vector<Mine> mines;
+		for (const auto& mine : chunk.mines)
+		{
+			auto gold = entityManager.getComponent<GoldComponent>(mine.second);
+			if (gold != nullptr)
+			{
+				mines.push_back(Mine{ mine.first, gold->currentAmount, gold->maxAmount });
+				uint32_t tile = (top + mine.first / chunkWidth) * this->width + left + mine.first % chunkWidth;
+				if (this->world.getEconomyModel().pageOutMine(mine.second, tile))
+				{
+					this->pagedOutGold[tile] = gold->currentAmount;
+				}
+				this->world.discardEntity(mine.second);
+			}
+			else
+			{
+				// The mine is gone, its tile can be walked on
+				chunk.tiles[mine.first] = Tile::FREE;
+			}
+		}
+		write(index, chunk.tiles, mines);
+
+		// Removes the links of the resident neighbours into this chunk, neighbour links are symmetric
+		OccupancyMap& occupancy = this->world.getOccupancyMap();
+		for (auto node : chunk.nodes)
+		{
+			auto component = entityManager.getComponent<GridNodeComponent>(node);
+			if (component->resident != Component::NO_ENTITY)
+			{
+				occupancy.vacate(component->x, component->y);
+			}
+			occupancy.setWall(component->x, component->y, true);
+			for (uint32_t direction = Direction::UP; direction < Direction::PORTAL; ++direction)
+			{
+				uint32_t neighbour = component->neighbours[direction];
+				int32_t nx = (int32_t)component->x + offsets[direction][0];
+				int32_t ny = (int32_t)component->y + offsets[direction][1];
+				bool outside = nx < (int32_t)left || ny < (int32_t)top
+					|| nx >= (int32_t)(left + chunkWidth) || ny >= (int32_t)(top + chunkHeight);
+				if (outside && neighbour != Component::NO_ENTITY)
+				{
+					entityManager.getComponent<GridNodeComponent>(neighbour)->neighbours[opposite[direction]] = Component::NO_ENTITY;
+					this->world.getChangeTracker().markChanged<GridNodeComponent>(neighbour);
+				}
+			}
+			uint32_t partner = component->neighbours[Direction::PORTAL];
+			if (partner != Component::NO_ENTITY && getNodeChunk(partner) != index)
+			{
+				entityManager.getComponent<GridNodeComponent>(partner)->neighbours[Direction::PORTAL] = Component::NO_ENTITY;
+				this->world.getChangeTracker().markChanged<GridNodeComponent>(partner);
+			}
+		}
+		for (auto node : chunk.nodes)
+		{
+			this->world.discardEntity(node);
+		}
+		for (auto portal : chunk.portals)
+		{
+			this->world.discardEntity(portal);
+		}
+
+		// Gives the memory back, paged out chunks only keep their record
+		std::vector<Tile>{}.swap(chunk.tiles);
+		std::vector<uint32_t>{}.swap(chunk.nodes);
+		std::vector<std::pair<uint16_t, uint32_t>>{}.swap(chunk.mines);
+		std::vector<uint32_t>{}.swap(chunk.portals);
+		chunk.resident = false;
+		this->resident.erase(std::find(this->resident.begin(), this->resident.end(), index));
+	}
+
+	void ChunkStreamer::markNeeded(const Vec2& position, std::vector<uint32_t>& toLoad)
+	{
+		uint32_t center = getChunk(position);
+		int32_t centerX = (int32_t)(center % this->chunksX);
+		int32_t centerY = (int32_t)(center / this->chunksX);
+		int32_t range = (int32_t)this->radius;
+
+		for (int32_t y = std::max(centerY - range, 0); y <= std::min(centerY + range, (int32_t)this->chunksY - 1); ++y)
+		{
+			for (int32_t x = std::max(centerX - range, 0); x <= std::min(centerX + range, (int32_t)this->chunksX - 1); ++x)
+			{
+				Chunk& chunk = this->chunks[y * this->chunksX + x];
+				if (chunk.lastNeeded == this->frame)
+				{
+					continue;
+				}
+				chunk.lastNeeded = this->frame;
+				if (!chunk.resident)
+				{
+					toLoad.push_back(y * this->chunksX + x);
+				}
+			}
+		}
+	}
+
+	void ChunkStreamer::findPinned(std::vector<uint8_t>& pinned) const
+	{
+		EntityManager& entityManager = this->world.getEntityManager();
+		pinned.assign(this->chunks.size(), 0);
+		// Units stand on the last node of their path
+		for (const auto& path : entityManager.getComponentContainer<PathfindingComponent>())
+		{
+			uint32_t chunk = getNodeChunk(path.second.lastId);
+			if (chunk != NO_CHUNK)
+			{
+				pinned[chunk] = 1;
+			}
+		}
+		for (const auto& structure : entityManager.getComponentContainer<StructureComponent>())
+		{
+			for (uint32_t node : structure.second.residences)
+			{
+				uint32_t chunk = getNodeChunk(node);
+				if (chunk != NO_CHUNK)
+				{
+					pinned[chunk] = 1;
+				}
+			}
+		}
+
+		for (uint32_t index : this->resident)
+		{
+			const Chunk& chunk = this->chunks[index];
+			for (uint32_t local = 0; local < chunk.nodes.size() && !pinned[index]; ++local)
+			{
+				auto node = entityManager.getComponent<GridNodeComponent>(chunk.nodes[local]);
+				bool ownMine = std::find_if(chunk.mines.begin(), chunk.mines.end(), [&node](const std::pair<uint16_t, uint32_t>& mine)
+				{
+					return mine.second == node->resident;
+				}) != chunk.mines.end();
+				if ((node->resident != Component::NO_ENTITY && !ownMine) || node->free != isPassable(chunk.tiles[local]))
+				{
+					pinned[index] = 1;
+				}
+			}
+		}
+	}
+
+	void ChunkStreamer::cutPaths(uint32_t index)
+	{
+		EntityManager& entityManager = this->world.getEntityManager();
+		for (auto& pair : entityManager.getComponentContainer<PathfindingComponent>())
+		{
+			uint32_t entity = pair.first;
+			PathfindingComponent& path = pair.second;
+			size_t kept = 0;
+			while (kept < path.pathQueue.size() && getNodeChunk(path.pathQueue[kept]) != index)
+			{
+				++kept;
+			}
+			bool targetLost = getNodeChunk(path.targetId) == index;
+			if (kept == path.pathQueue.size() && !targetLost)
+			{
+				continue;
+			}
+
+			while (path.pathQueue.size() > kept)
+			{
+				path.pathQueue.pop_back();
+			}
+			if (targetLost)
+			{
+				// Walks as far as the path is resident, the rest is requested once the target is back
+				auto target = entityManager.getComponent<GridNodeComponent>(path.targetId);
+				path.targetId = path.pathQueue.empty() ? path.lastId : path.pathQueue.back();
+				this->detours[entity] = Detour{ target->y * this->width + target->x, path.targetId };
+			}
+			else
+			{
+				// Around the unloaded chunk (the graph is rebuilt without it)
+				this->world.getPathRequestQueue().request(entity, path.lastId, path.targetId);
+			}
+		}
+	}
+
+	uint32_t ChunkStreamer::getNodeChunk(uint32_t node) const
+	{
+		auto component = this->world.getEntityManager().getComponent<GridNodeComponent>(node);
+		if (component == nullptr)
+		{
+			return NO_CHUNK;
+		}
+		return (component->y / chunkSize) * this->chunksX + component->x / chunkSize;
+	}
+
+	Vec2 ChunkStreamer::getTilePosition(uint32_t x, uint32_t y) const
+	{
+		return Vec2{ x * this->tileSize, y * this->tileSize };
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
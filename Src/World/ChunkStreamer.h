@@ -0,0 +1,160 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "math/Vec2.h"
+
+#include "LevelGenerators/ChunkedLevelGenerator.h"
+
+namespace RioGame
+{
+
+	using ::RioEngine::Vec2;
+
+	class World;
+
+	// Cheap summary of a chunk, kept for every chunk while the chunk itself may be paged out
+	struct ChunkSummary
+	{
+		// Gold left in the chunk's mines, parked miners keep mining it while the chunk is paged out
+		uint32_t gold = 0;
+		uint32_t freeTiles = 0;
+		uint16_t mines = 0;
+		uint16_t portals = 0;
+	};
+
+	// Chunked world mode for maps too big to keep all grid nodes resident
+	// Only chunks around the focus (camera) and around units that can move have their grid node,
+	// mine and portal entities, other chunks live in a storage file (run length encoded tiles and the
+	// gold left in their mines) and are represented by their ChunkSummary in the meantime
+	// Resident chunks nobody needs stay loaded until more than maxResident chunks are resident,
+	// then the least recently needed ones are written back and unloaded
+	// The record only has the tiles and the mines, chunks with more state stay resident: units standing
+	// on their nodes, structures, residents other than their mines and nodes blocked or freed at runtime
+	// A written back chunk reuses its record's slot in the file, so the file doesn't grow while playing
+	// Entities are created and destroyed through the World, so the queries and the change tracker see them
+	// Paths leading through an unloaded chunk end before it, they are requested again around it (or to
+	// their target once the target's chunk is resident again)
+	class ChunkStreamer
+	{
+	public:
+		static constexpr uint32_t chunkSize = LevelGenerators::ChunkedLevelGenerator::chunkSize;
+
+		// Called after a chunk got loaded and before a chunk gets unloaded
+		using LoadHandler = std::function<void(uint32_t chunk)>;
+		using UnloadHandler = std::function<void(uint32_t chunk)>;
+
+		ChunkStreamer(World& world, const std::string& storagePath);
+		ChunkStreamer(const ChunkStreamer&) = delete;
+		ChunkStreamer& operator=(const ChunkStreamer&) = delete;
+
+		// Writes all chunks of the generated map to the storage, no chunk is resident afterwards
+		// tileSize is the distance of two nodes in the world, the generator isn't needed anymore afterwards
+		void init(const LevelGenerators::ChunkedLevelGenerator& generator, float tileSize = 1.0f);
+		// Loads and unloads chunks around the focus and the moving units, at most maxLoadsPerUpdate chunks get loaded per call
+		void update(const Vec2& focus);
+		// Writes all resident chunks back and unloads them
+		void unloadAll();
+		// Takes up to amount gold from a paged out mine (the key the EconomyModel got for it), returns the gold taken
+		uint32_t drawGold(uint32_t mine, uint32_t amount);
+
+		void setLoadHandler(const LoadHandler& handler);
+		void setUnloadHandler(const UnloadHandler& handler);
+		// Radius (in chunks) of the square of chunks kept around the focus and every unit
+		void setResidencyRadius(uint32_t radius);
+		void setMaxResident(uint32_t maxResident);
+		void setMaxLoadsPerUpdate(uint32_t maxLoads);
+
+		// Returns the grid node at the tile or Component::NO_ENTITY if its chunk isn't resident
+		uint32_t getNode(uint32_t x, uint32_t y) const;
+		uint32_t getChunk(const Vec2& position) const;
+		bool isResident(uint32_t chunk) const;
+		const ChunkSummary& getSummary(uint32_t chunk) const;
+		uint32_t getChunkCount() const;
+		uint32_t getResidentCount() const;
+	private:
+		using Tile = LevelGenerators::Tile;
+
+		static constexpr uint32_t NO_CHUNK = uint32_t(-1);
+
+		struct Mine
+		{
+			uint16_t tile;
+			uint32_t gold;
+			uint32_t maxGold;
+		};
+
+		struct Chunk
+		{
+			// Location of the last written record in the storage, capacity is the size of its slot
+			uint64_t offset = 0;
+			uint32_t size = 0;
+			uint32_t capacity = 0;
+			ChunkSummary summary;
+
+			// Resident data, empty while the chunk is paged out
+			std::vector<Tile> tiles;
+			std::vector<uint32_t> nodes;
+			// Local tile index and entity of every mine
+			std::vector<std::pair<uint16_t, uint32_t>> mines;
+			std::vector<uint32_t> portals;
+			uint32_t lastNeeded = 0;
+			bool resident = false;
+		};
+
+		// Target of a path cut by an unload and the resident node the entity walks to meanwhile
+		struct Detour
+		{
+			uint32_t tile;
+			uint32_t standIn;
+		};
+
+		void write(uint32_t chunk, const std::vector<Tile>& tiles, const std::vector<Mine>& mines);
+		void read(uint32_t chunk, std::vector<Tile>& tiles, std::vector<Mine>& mines);
+		void load(uint32_t chunk);
+		void unload(uint32_t chunk);
+		void markNeeded(const Vec2& position, std::vector<uint32_t>& toLoad);
+		// Marks the chunks whose state can't be written to their record in pinned
+		void findPinned(std::vector<uint8_t>& pinned) const;
+		// Ends the paths leading into the chunk before it and requests them again
+		void cutPaths(uint32_t chunk);
+		// Chunk of a grid node entity, NO_CHUNK if it isn't one
+		uint32_t getNodeChunk(uint32_t node) const;
+		Vec2 getTilePosition(uint32_t x, uint32_t y) const;
+
+		World& world;
+		std::string storagePath;
+		std::fstream storage;
+		uint64_t storageEnd = 0;
+
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t chunksX = 0;
+		uint32_t chunksY = 0;
+		float tileSize = 1.0f;
+		std::vector<Chunk> chunks;
+		std::vector<uint32_t> resident;
+		// Linked portals by global tile index, both directions
+		std::unordered_map<uint32_t, uint32_t> portalPartners;
+		// Gold left in paged out mines that parked miners draw from, by global tile index
+		std::unordered_map<uint32_t, uint32_t> pagedOutGold;
+		// Paths cut by an unload whose target was in the unloaded chunk, by entity
+		std::unordered_map<uint32_t, Detour> detours;
+
+		uint32_t radius = 2;
+		uint32_t maxResident = 256;
+		uint32_t maxLoadsPerUpdate = 8;
+		uint32_t frame = 0;
+
+		LoadHandler loadHandler;
+		UnloadHandler unloadHandler;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
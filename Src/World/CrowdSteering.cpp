@@ -0,0 +1,410 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "CrowdSteering.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "Components.h"
+#include "EntityManager.h"
+#include "SpatialGrid.h"
+#include "Tools/ThreadPool.h"
+
+namespace RioGame
+{
+
+	constexpr uint32_t CrowdSteering::maxNeighbours;
+
+	namespace
+	{
+		const float epsilon = 0.00001f;
+		// Units per job
+		const uint32_t grain = 256;
+
+		float dot(const Vec2& lhs, const Vec2& rhs)
+		{
+			return lhs.x * rhs.x + lhs.y * rhs.y;
+		}
+
+		float det(const Vec2& lhs, const Vec2& rhs)
+		{
+			return lhs.x * rhs.y - lhs.y * rhs.x;
+		}
+
+		Vec2 normalized(const Vec2& vector)
+		{
+			float length = std::sqrt(dot(vector, vector));
+			return length > epsilon ? vector * (1.0f / length) : Vec2{ 0.0f, 0.0f };
+		}
+
+		// The following solve the linear program of the velocity obstacle half planes (see van den Berg et al.,
+		// "Reciprocal n-body collision avoidance"), velocities on the left of a line's direction are allowed
+		template<typename Line>
+		bool solveOnLine(const Line* lines, uint32_t line, float radius, const Vec2& optimal, bool directionOptimal, Vec2& result)
+		{
+			float dotProduct = dot(lines[line].point, lines[line].direction);
+			float discriminant = dotProduct * dotProduct + radius * radius - dot(lines[line].point, lines[line].point);
+			if (discriminant < 0.0f)
+			{
+				// The speed circle doesn't reach the line
+				return false;
+			}
+
+			float sqrtDiscriminant = std::sqrt(discriminant);
+			float left = -dotProduct - sqrtDiscriminant;
+			float right = -dotProduct + sqrtDiscriminant;
+			for (uint32_t i = 0; i < line; ++i)
+			{
+				float denominator = det(lines[line].direction, lines[i].direction);
+				float numerator = det(lines[i].direction, lines[line].point - lines[i].point);
+				if (std::abs(denominator) <= epsilon)
+				{
+					// Parallel lines
+					if (numerator < 0.0f)
+					{
+						return false;
+					}
+					continue;
+				}
+
+				float t = numerator / denominator;
+				if (denominator >= 0.0f)
+				{
+					right = std::min(right, t);
+				}
+				else
+				{
+					left = std::max(left, t);
+				}
+				if (left > right)
+				{
+					return false;
+				}
+			}
+
+			if (directionOptimal)
+			{
+				result = lines[line].point + lines[line].direction * (dot(optimal, lines[line].direction) > 0.0f ? right : left);
+			}
+			else
+			{
+				float t = std::max(left, std::min(right, dot(lines[line].direction, optimal - lines[line].point)));
+				result = lines[line].point + lines[line].direction * t;
+			}
+			return true;
+		}
+
+		// Returns the index of the first line that couldn't be satisfied or count if all are
+		template<typename Line>
+		uint32_t solvePlanes(const Line* lines, uint32_t count, float radius, const Vec2& optimal, bool directionOptimal, Vec2& result)
+		{
+			if (directionOptimal)
+			{
+				result = optimal * radius;
+			}
+			else if (dot(optimal, optimal) > radius * radius)
+			{
+				result = normalized(optimal) * radius;
+			}
+			else
+			{
+				result = optimal;
+			}
+
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				if (det(lines[i].direction, lines[i].point - result) > 0.0f)
+				{
+					Vec2 previous = result;
+					if (!solveOnLine(lines, i, radius, optimal, directionOptimal, result))
+					{
+						result = previous;
+						return i;
+					}
+				}
+			}
+			return count;
+		}
+
+		// Too crowded to satisfy all lines, minimizes the largest violation instead
+		template<typename Line, size_t capacity>
+		void solveDense(const std::array<Line, capacity>& lines, uint32_t count, uint32_t first, float radius, Vec2& result)
+		{
+			float distance = 0.0f;
+			std::array<Line, capacity> projected;
+			for (uint32_t i = first; i < count; ++i)
+			{
+				if (det(lines[i].direction, lines[i].point - result) <= distance)
+				{
+					continue;
+				}
+
+				uint32_t projectedCount = 0;
+				for (uint32_t j = 0; j < i; ++j)
+				{
+					Line line;
+					float denominator = det(lines[i].direction, lines[j].direction);
+					if (std::abs(denominator) <= epsilon)
+					{
+						if (dot(lines[i].direction, lines[j].direction) > 0.0f)
+						{
+							continue;
+						}
+						line.point = (lines[i].point + lines[j].point) * 0.5f;
+					}
+					else
+					{
+						line.point = lines[i].point + lines[i].direction * (det(lines[j].direction, lines[i].point - lines[j].point) / denominator);
+					}
+					line.direction = normalized(lines[j].direction - lines[i].direction);
+					projected[projectedCount++] = line;
+				}
+
+				Vec2 previous = result;
+				if (solvePlanes(projected.data(), projectedCount, radius, Vec2{ -lines[i].direction.y, lines[i].direction.x }, true, result) < projectedCount)
+				{
+					result = previous;
+				}
+				distance = det(lines[i].direction, lines[i].point - result);
+			}
+		}
+	}
+
+	CrowdSteering::CrowdSteering(EntityManager& entityManager, ThreadPool& threadPool, const SpatialGrid& positions)
+		: entityManager{ entityManager }
+		, threadPool{ threadPool }
+		, positions{ positions }
+	{
+	}
+
+	void CrowdSteering::setPreferredVelocity(uint32_t entity, const Vec2& velocity)
+	{
+		this->preferred[entity] = velocity;
+	}
+
+	void CrowdSteering::process(float delta)
+	{
+		this->entities.clear();
+		this->positionX.clear();
+		this->positionY.clear();
+		this->velocityX.clear();
+		this->velocityY.clear();
+		this->preferredX.clear();
+		this->preferredY.clear();
+		this->maxSpeed.clear();
+		this->agentIndices.clear();
+
+		for (const auto& pair : this->preferred)
+		{
+			auto physics = this->entityManager.getComponent<PhysicsComponent>(pair.first);
+			auto movement = this->entityManager.getComponent<MovementComponent>(pair.first);
+			if (physics == nullptr || movement == nullptr)
+			{
+				continue;
+			}
+
+			Vec2 velocity = getVelocity(pair.first);
+			this->agentIndices.emplace(pair.first, (uint32_t)this->entities.size());
+			this->entities.push_back(pair.first);
+			this->positionX.push_back(physics->position.x);
+			this->positionY.push_back(physics->position.y);
+			this->velocityX.push_back(velocity.x);
+			this->velocityY.push_back(velocity.y);
+			this->preferredX.push_back(pair.second.x);
+			this->preferredY.push_back(pair.second.y);
+			this->maxSpeed.push_back(movement->speedModifier);
+		}
+		this->preferred.clear();
+
+		uint32_t count = (uint32_t)this->entities.size();
+		this->neighbours.resize(count * maxNeighbours);
+		this->neighbourCounts.resize(count);
+		this->results.resize(count);
+		// Jobs only read the components, the grid and the arrays above and write their own entries
+		this->threadPool.parallelFor(count, grain, [this, delta](uint32_t begin, uint32_t end, uint32_t)
+		{
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				gather(i);
+				solve(i, delta);
+			}
+		});
+
+		this->velocities.clear();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			this->velocities.emplace(this->entities[i], this->results[i]);
+		}
+	}
+
+	Vec2 CrowdSteering::getVelocity(uint32_t entity) const
+	{
+		auto it = this->velocities.find(entity);
+		return it != this->velocities.end() ? it->second : Vec2{ 0.0f, 0.0f };
+	}
+
+	const std::vector<uint32_t>& CrowdSteering::getAgents() const
+	{
+		return this->entities;
+	}
+
+	Vec2 CrowdSteering::getAgentPosition(uint32_t agent) const
+	{
+		return Vec2{ this->positionX[agent], this->positionY[agent] };
+	}
+
+	void CrowdSteering::setAgentRadius(float radius)
+	{
+		this->agentRadius = radius;
+	}
+
+	void CrowdSteering::setTimeHorizon(float seconds)
+	{
+		this->timeHorizon = seconds;
+	}
+
+	void CrowdSteering::setNeighbourDistance(float distance)
+	{
+		this->neighbourDistance = distance;
+	}
+
+	void CrowdSteering::clear()
+	{
+		this->preferred.clear();
+		this->velocities.clear();
+		this->entities.clear();
+		this->positionX.clear();
+		this->positionY.clear();
+		this->agentIndices.clear();
+	}
+
+	void CrowdSteering::gather(uint32_t agent)
+	{
+		Neighbour* nearest = &this->neighbours[agent * maxNeighbours];
+		uint32_t& count = this->neighbourCounts[agent];
+		count = 0;
+
+		uint32_t self = this->entities[agent];
+		Vec2 position{ this->positionX[agent], this->positionY[agent] };
+		// The grid only finds the candidates, it holds the positions last reported to the ChangeTracker
+		this->positions.forEachInRadius(position, this->neighbourDistance, [&](uint32_t entity, const Vec2&)
+		{
+			if (entity == self)
+			{
+				return;
+			}
+
+			Neighbour neighbour;
+			auto index = this->agentIndices.find(entity);
+			if (index != this->agentIndices.end())
+			{
+				neighbour.position = Vec2{ this->positionX[index->second], this->positionY[index->second] };
+				neighbour.velocity = Vec2{ this->velocityX[index->second], this->velocityY[index->second] };
+				neighbour.share = 0.5f;
+			}
+			else
+			{
+				auto physics = this->entityManager.getComponent<PhysicsComponent>(entity);
+				if (physics == nullptr || !physics->solid)
+				{
+					return;
+				}
+				neighbour.position = physics->position;
+				neighbour.velocity = Vec2{ 0.0f, 0.0f };
+				neighbour.share = 1.0f;
+			}
+			neighbour.distanceSquared = dot(neighbour.position - position, neighbour.position - position);
+			if (neighbour.distanceSquared > this->neighbourDistance * this->neighbourDistance)
+			{
+				return;
+			}
+
+			// Keeps the nearest ones, sorted by distance
+			if (count == maxNeighbours && neighbour.distanceSquared >= nearest[count - 1].distanceSquared)
+			{
+				return;
+			}
+			uint32_t slot = count < maxNeighbours ? count++ : count - 1;
+			while (slot > 0 && nearest[slot - 1].distanceSquared > neighbour.distanceSquared)
+			{
+				nearest[slot] = nearest[slot - 1];
+				--slot;
+			}
+			nearest[slot] = neighbour;
+		});
+	}
+
+	void CrowdSteering::solve(uint32_t agent, float delta)
+	{
+		const Neighbour* nearest = &this->neighbours[agent * maxNeighbours];
+		uint32_t count = this->neighbourCounts[agent];
+		Vec2 position{ this->positionX[agent], this->positionY[agent] };
+		Vec2 velocity{ this->velocityX[agent], this->velocityY[agent] };
+		float combinedRadius = 2.0f * this->agentRadius;
+		float combinedRadiusSquared = combinedRadius * combinedRadius;
+		float inverseHorizon = 1.0f / this->timeHorizon;
+
+		std::array<Line, maxNeighbours> lines;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			Vec2 relativePosition = nearest[i].position - position;
+			Vec2 relativeVelocity = velocity - nearest[i].velocity;
+			float distanceSquared = nearest[i].distanceSquared;
+			Vec2 u;
+			Line& line = lines[i];
+
+			if (distanceSquared > combinedRadiusSquared)
+			{
+				// Velocity relative to the center of the cut-off circle of the velocity obstacle
+				Vec2 w = relativeVelocity - relativePosition * inverseHorizon;
+				float wLengthSquared = dot(w, w);
+				float projection = dot(w, relativePosition);
+				if (projection < 0.0f && projection * projection > combinedRadiusSquared * wLengthSquared)
+				{
+					// Closest to the cut-off circle
+					float wLength = std::sqrt(wLengthSquared);
+					Vec2 unitW = w * (1.0f / wLength);
+					line.direction = Vec2{ unitW.y, -unitW.x };
+					u = unitW * (combinedRadius * inverseHorizon - wLength);
+				}
+				else
+				{
+					// Closest to one of the legs
+					float leg = std::sqrt(distanceSquared - combinedRadiusSquared);
+					if (det(relativePosition, w) > 0.0f)
+					{
+						line.direction = Vec2{ relativePosition.x * leg - relativePosition.y * combinedRadius
+							, relativePosition.x * combinedRadius + relativePosition.y * leg } * (1.0f / distanceSquared);
+					}
+					else
+					{
+						line.direction = Vec2{ relativePosition.x * leg + relativePosition.y * combinedRadius
+							, -relativePosition.x * combinedRadius + relativePosition.y * leg } * (-1.0f / distanceSquared);
+					}
+					u = line.direction * dot(relativeVelocity, line.direction) - relativeVelocity;
+				}
+			}
+			else
+			{
+				// Already overlapping, pushes apart within this tick
+				float inverseDelta = 1.0f / std::max(delta, epsilon);
+				Vec2 w = relativeVelocity - relativePosition * inverseDelta;
+				float wLength = std::sqrt(dot(w, w));
+				Vec2 unitW = wLength > epsilon ? w * (1.0f / wLength) : Vec2{ 1.0f, 0.0f };
+				line.direction = Vec2{ unitW.y, -unitW.x };
+				u = unitW * (combinedRadius * inverseDelta - wLength);
+			}
+			line.point = velocity + u * nearest[i].share;
+		}
+
+		Vec2 preferredVelocity{ this->preferredX[agent], this->preferredY[agent] };
+		Vec2& result = this->results[agent];
+		uint32_t failed = solvePlanes(lines.data(), count, this->maxSpeed[agent], preferredVelocity, false, result);
+		if (failed < count)
+		{
+			solveDense(lines, count, failed, this->maxSpeed[agent], result);
+		}
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
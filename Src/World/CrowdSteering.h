@@ -0,0 +1,99 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "math/Vec2.h"
+
+namespace RioGame
+{
+
+	using ::RioEngine::Vec2;
+
+	class EntityManager;
+	class ThreadPool;
+	class SpatialGrid;
+
+	// Local avoidance of moving units (optimal reciprocal collision avoidance, ORCA)
+	// The MovementSystem reports the velocity each unit wants (towards the next node of its path),
+	// process turns them into velocities that don't run into the neighbours within the next
+	// timeHorizon seconds. Each unit looks at its maxNeighbours nearest neighbours from the spatial
+	// grid, moving units share the avoidance, solid entities that don't move are avoided fully
+	// Units are solved in parallel from contiguous arrays, the results are read by the MovementSystem
+	// Preferred velocities reported during a tick are steered at the start of the next one
+	class CrowdSteering
+	{
+	public:
+		static constexpr uint32_t maxNeighbours = 8;
+
+		CrowdSteering(EntityManager& entityManager, ThreadPool& threadPool, const SpatialGrid& positions);
+		CrowdSteering(const CrowdSteering&) = delete;
+		CrowdSteering& operator=(const CrowdSteering&) = delete;
+
+		void setPreferredVelocity(uint32_t entity, const Vec2& velocity);
+		// Computes the velocities of all units that reported a preferred velocity since the last call
+		void process(float delta);
+		// Steered velocity of the entity, zero if it didn't ask for one
+		Vec2 getVelocity(uint32_t entity) const;
+		// Units steered by the last process call, the ones the MovementSystem moves in this tick
+		const std::vector<uint32_t>& getAgents() const;
+		// Position of an agent (index into getAgents) when it was steered
+		Vec2 getAgentPosition(uint32_t agent) const;
+
+		// Radius of a unit in world units
+		void setAgentRadius(float radius);
+		// Seconds ahead in which collisions are avoided, longer makes units react earlier and more cautiously
+		void setTimeHorizon(float seconds);
+		// Distance up to which other units are considered
+		void setNeighbourDistance(float distance);
+		void clear();
+	private:
+		struct Line
+		{
+			Vec2 point;
+			Vec2 direction;
+		};
+
+		void gather(uint32_t agent);
+		void solve(uint32_t agent, float delta);
+
+		EntityManager& entityManager;
+		ThreadPool& threadPool;
+		const SpatialGrid& positions;
+
+		float agentRadius = 0.35f;
+		float timeHorizon = 2.0f;
+		float neighbourDistance = 3.0f;
+
+		std::unordered_map<uint32_t, Vec2> preferred;
+		std::unordered_map<uint32_t, Vec2> velocities;
+		std::unordered_map<uint32_t, uint32_t> agentIndices;
+
+		// One entry per unit
+		std::vector<uint32_t> entities;
+		std::vector<float> positionX;
+		std::vector<float> positionY;
+		std::vector<float> velocityX;
+		std::vector<float> velocityY;
+		std::vector<float> preferredX;
+		std::vector<float> preferredY;
+		std::vector<float> maxSpeed;
+		std::vector<Vec2> results;
+
+		// maxNeighbours entries per unit, neighbourCounts of them are used
+		struct Neighbour
+		{
+			Vec2 position;
+			Vec2 velocity;
+			// Part of the avoidance this unit takes on, 0.5 for units and 1 for entities that don't move
+			float share;
+			float distanceSquared;
+		};
+		std::vector<Neighbour> neighbours;
+		std::vector<uint32_t> neighbourCounts;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
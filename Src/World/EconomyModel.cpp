@@ -0,0 +1,304 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "EconomyModel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Components.h"
+#include "EntityManager.h"
+#include "ChangeTracker.h"
+#include "VisibilityIndex.h"
+
+namespace RioGame
+{
+
+	namespace
+	{
+		// Deposits on the same route before the route counts as established
+		const uint32_t establishedTrips = 3;
+		// Allowed difference of two consecutive cycle times (relative)
+		const float steadyTolerance = 0.25f;
+	}
+
+	EconomyModel::EconomyModel(EntityManager& entityManager, ChangeTracker& changes, VisibilityIndex& visibility)
+		: entityManager{ entityManager }
+		, changes{ changes }
+		, visibility{ visibility }
+	{
+		this->healthSubscription = changes.subscribe(HealthComponent::type, (uint8_t)ChangeKind::CHANGED);
+	}
+
+	EconomyModel::~EconomyModel()
+	{
+		this->changes.unsubscribe(this->healthSubscription);
+	}
+
+	void EconomyModel::recordDeposit(uint32_t miner, uint32_t mine, uint32_t storage, uint32_t gold, float now)
+	{
+		Route& route = this->routes[miner];
+		if (route.parked)
+		{
+			// The task system only runs for awake miners
+			unpark(miner, route);
+		}
+
+		if (route.trips == 0 || route.pagedOut || route.mine != mine || route.storage != storage)
+		{
+			route = Route{};
+			route.mine = mine;
+			route.storage = storage;
+			route.goldPerTrip = gold;
+			route.trips = 1;
+			route.lastDeposit = now;
+			return;
+		}
+
+		float cycleTime = now - route.lastDeposit;
+		route.steady = route.cycleTime > 0.0f
+			&& std::abs(cycleTime - route.cycleTime) <= steadyTolerance * route.cycleTime;
+		// Smoothed, a single slow trip (blocked path) doesn't throw the estimate off
+		route.cycleTime = route.cycleTime > 0.0f ? 0.5f * (route.cycleTime + cycleTime) : cycleTime;
+		route.goldPerTrip = gold;
+		route.lastDeposit = now;
+		++route.trips;
+	}
+
+	void EconomyModel::update(float delta, float now)
+	{
+		// Hurt miners fight back or flee, that needs the full simulation (regeneration doesn't wake them)
+		this->changes.forEachChange(this->healthSubscription, [this](uint32_t entity, ChangeKind)
+		{
+			auto it = this->routes.find(entity);
+			auto health = this->entityManager.getComponent<HealthComponent>(entity);
+			if (it == this->routes.end() || !it->second.parked || health == nullptr)
+			{
+				return;
+			}
+
+			if (health->currentHealthPoints < it->second.health)
+			{
+				this->toWake.push_back(entity);
+			}
+			it->second.health = health->currentHealthPoints;
+		});
+		for (uint32_t miner : this->toWake)
+		{
+			auto it = this->routes.find(miner);
+			if (it != this->routes.end() && it->second.parked)
+			{
+				unpark(miner, it->second);
+			}
+		}
+		this->toWake.clear();
+
+		uint32_t income = 0;
+		this->incomeRate = 0.0f;
+		for (auto it = this->routes.begin(); it != this->routes.end();)
+		{
+			uint32_t miner = it->first;
+			Route& route = it->second;
+			if (this->entityManager.getComponent<TaskHandlerComponent>(miner) == nullptr)
+			{
+				// Dead or not a worker anymore
+				if (route.parked)
+				{
+					--this->parkedCount;
+				}
+				it = this->routes.erase(it);
+				continue;
+			}
+			++it;
+
+			if (!route.parked)
+			{
+				if (canPark(miner, route, now))
+				{
+					auto health = this->entityManager.getComponent<HealthComponent>(miner);
+					route.health = health != nullptr ? health->currentHealthPoints : 0;
+					route.parked = true;
+					route.pending = 0.0f;
+					++this->parkedCount;
+				}
+				continue;
+			}
+
+			auto gold = route.pagedOut ? nullptr : this->entityManager.getComponent<GoldComponent>(route.mine);
+			bool available = route.pagedOut ? (bool)this->goldSource : gold != nullptr && gold->currentAmount > 0;
+			if (!available || isRelevant(miner, route))
+			{
+				unpark(miner, route);
+				continue;
+			}
+
+			float rate = route.goldPerTrip / route.cycleTime;
+			route.pending += rate * delta;
+			uint32_t wanted = (uint32_t)route.pending;
+			if (route.pagedOut)
+			{
+				uint32_t mined = wanted > 0 ? this->goldSource(route.mine, wanted) : 0;
+				route.pending -= mined;
+				income += mined;
+				if (mined < wanted)
+				{
+					// Ran dry while paged out
+					unpark(miner, route);
+					continue;
+				}
+			}
+			else
+			{
+				uint32_t mined = std::min(wanted, gold->currentAmount);
+				if (mined > 0)
+				{
+					route.pending -= mined;
+					gold->currentAmount -= mined;
+					this->changes.markChanged<GoldComponent>(route.mine);
+					income += mined;
+				}
+			}
+			this->incomeRate += rate;
+		}
+
+		if (income > 0 && this->incomeHandler)
+		{
+			this->incomeHandler(income);
+		}
+	}
+
+	void EconomyModel::wake(uint32_t miner)
+	{
+		auto it = this->routes.find(miner);
+		if (it == this->routes.end())
+		{
+			return;
+		}
+
+		if (it->second.parked)
+		{
+			unpark(miner, it->second);
+		}
+		else
+		{
+			it->second.trips = 0;
+		}
+	}
+
+	bool EconomyModel::pageOutMine(uint32_t mine, uint32_t key)
+	{
+		bool mined = false;
+		for (auto& pair : this->routes)
+		{
+			Route& route = pair.second;
+			if (route.pagedOut || route.mine != mine)
+			{
+				continue;
+			}
+
+			if (route.parked)
+			{
+				route.mine = key;
+				route.pagedOut = true;
+				mined = true;
+			}
+			else
+			{
+				// The awake miner's next trip goes somewhere else
+				route.trips = 0;
+			}
+		}
+		return mined;
+	}
+
+	void EconomyModel::pageInMine(uint32_t key, uint32_t mine)
+	{
+		for (auto& pair : this->routes)
+		{
+			Route& route = pair.second;
+			if (route.pagedOut && route.mine == key)
+			{
+				route.mine = mine;
+				route.pagedOut = false;
+			}
+		}
+	}
+
+	bool EconomyModel::isParked(uint32_t miner) const
+	{
+		auto it = this->routes.find(miner);
+		return it != this->routes.end() && it->second.parked;
+	}
+
+	uint32_t EconomyModel::getParkedCount() const
+	{
+		return this->parkedCount;
+	}
+
+	float EconomyModel::getIncomeRate() const
+	{
+		return this->incomeRate;
+	}
+
+	void EconomyModel::setIncomeHandler(const IncomeHandler& handler)
+	{
+		this->incomeHandler = handler;
+	}
+
+	void EconomyModel::setWakeHandler(const WakeHandler& handler)
+	{
+		this->wakeHandler = handler;
+	}
+
+	void EconomyModel::setGoldSource(const GoldSource& source)
+	{
+		this->goldSource = source;
+	}
+
+	void EconomyModel::clear()
+	{
+		this->routes.clear();
+		this->toWake.clear();
+		this->parkedCount = 0;
+		this->incomeRate = 0.0f;
+	}
+
+	bool EconomyModel::canPark(uint32_t miner, const Route& route, float now) const
+	{
+		if (route.trips < establishedTrips || !route.steady || route.goldPerTrip == 0)
+		{
+			return false;
+		}
+		// A miner that stopped depositing left its route
+		if (now - route.lastDeposit > 2.0f * route.cycleTime)
+		{
+			return false;
+		}
+
+		auto gold = this->entityManager.getComponent<GoldComponent>(route.mine);
+		return gold != nullptr && gold->currentAmount > 0 && !isRelevant(miner, route);
+	}
+
+	bool EconomyModel::isRelevant(uint32_t miner, const Route& route) const
+	{
+		// Without a view everything is visible, so nothing gets parked
+		return this->visibility.isVisible(miner)
+			|| (!route.pagedOut && this->visibility.isVisible(route.mine))
+			|| this->visibility.isVisible(route.storage)
+			|| this->entityManager.getComponent<PhysicsComponent>(route.storage) == nullptr;
+	}
+
+	void EconomyModel::unpark(uint32_t miner, Route& route)
+	{
+		route.parked = false;
+		--this->parkedCount;
+		// The time spent parked isn't a trip, the route has to be established again
+		route.trips = 0;
+		route.steady = false;
+		route.cycleTime = 0.0f;
+		if (this->wakeHandler)
+		{
+			this->wakeHandler(miner);
+		}
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,99 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace RioGame
+{
+
+	class EntityManager;
+	class ChangeTracker;
+	class VisibilityIndex;
+
+	// Aggregate model of the gold mining loops (GO_PICK_UP_GOLD, PICK_UP_GOLD, GO_DEPOSIT_GOLD, DEPOSIT_GOLD)
+	// A miner whose last deposits went from the same mine to the same storage in steady intervals is on an
+	// established route. Established miners nobody looks at are parked: they keep their position, their
+	// tasks and pathing are skipped and their route yields gold per second (taken from the mine) instead
+	// A parked miner wakes up (and the task system resumes its loop) as soon as it, its mine or its
+	// storage is visible, it gets hurt, the mine runs dry or one of the entities is gone
+	// In the chunked world mode a parked miner's mine may get paged out, the miner keeps mining it
+	// through the gold source until the mine is paged in again
+	class EconomyModel
+	{
+	public:
+		// Gold earned by all parked miners since the last call
+		using IncomeHandler = std::function<void(uint32_t gold)>;
+		using WakeHandler = std::function<void(uint32_t miner)>;
+		// Takes up to amount gold from a paged out mine, returns the gold taken
+		using GoldSource = std::function<uint32_t(uint32_t mine, uint32_t amount)>;
+
+		EconomyModel(EntityManager& entityManager, ChangeTracker& changes, VisibilityIndex& visibility);
+		EconomyModel(const EconomyModel&) = delete;
+		EconomyModel& operator=(const EconomyModel&) = delete;
+		~EconomyModel();
+
+		// Called by the task system whenever a miner finished a DEPOSIT_GOLD task
+		void recordDeposit(uint32_t miner, uint32_t mine, uint32_t storage, uint32_t gold, float now);
+		// Parks and wakes miners and pays out the income of the parked ones
+		void update(float delta, float now);
+		// Resumes the full simulation of the miner (e.g. when it gets a command), its route has to be established again
+		void wake(uint32_t miner);
+		// The mine entity is about to be destroyed with its paged out chunk, parked routes keep mining it
+		// from the gold source under the key, returns whether any does
+		bool pageOutMine(uint32_t mine, uint32_t key);
+		// The mine paged out under the key is resident again as the given entity
+		void pageInMine(uint32_t key, uint32_t mine);
+
+		bool isParked(uint32_t miner) const;
+		uint32_t getParkedCount() const;
+		// Gold per second of all parked miners
+		float getIncomeRate() const;
+
+		void setIncomeHandler(const IncomeHandler& handler);
+		void setWakeHandler(const WakeHandler& handler);
+		void setGoldSource(const GoldSource& source);
+		void clear();
+	private:
+		struct Route
+		{
+			uint32_t mine = 0;
+			uint32_t storage = 0;
+			uint32_t goldPerTrip = 0;
+			uint32_t trips = 0;
+			float lastDeposit = 0.0f;
+			// Seconds per mine-storage-mine round trip
+			float cycleTime = 0.0f;
+			// Gold earned while parked that isn't paid out yet
+			float pending = 0.0f;
+			// Health of the parked miner, a drop wakes it up
+			uint32_t health = 0;
+			bool steady = false;
+			bool parked = false;
+			// The mine is paged out, mine holds its key for the gold source
+			bool pagedOut = false;
+		};
+
+		bool canPark(uint32_t miner, const Route& route, float now) const;
+		bool isRelevant(uint32_t miner, const Route& route) const;
+		void unpark(uint32_t miner, Route& route);
+
+		EntityManager& entityManager;
+		ChangeTracker& changes;
+		VisibilityIndex& visibility;
+		uint32_t healthSubscription;
+
+		std::unordered_map<uint32_t, Route> routes;
+		std::vector<uint32_t> toWake;
+		uint32_t parkedCount = 0;
+		float incomeRate = 0.0f;
+
+		IncomeHandler incomeHandler;
+		WakeHandler wakeHandler;
+		GoldSource goldSource;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
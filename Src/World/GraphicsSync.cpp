@@ -0,0 +1,165 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "GraphicsSync.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "2d/CCSprite.h"
+
+#include "Components.h"
+#include "EntityManager.h"
+#include "ChangeTracker.h"
+#include "Tools/SpriteAtlas.h"
+
+namespace RioGame
+{
+
+	using ::RioEngine::Sprite;
+
+	GraphicsSync::GraphicsSync(EntityManager& entityManager, ChangeTracker& changes, SpriteAtlas& atlas)
+		: entityManager{ entityManager }
+		, changes{ changes }
+		, atlas{ atlas }
+	{
+		uint8_t kinds = (uint8_t)ChangeKind::ADDED | (uint8_t)ChangeKind::CHANGED;
+		this->physicsSubscription = changes.subscribe(PhysicsComponent::type, kinds);
+		this->graphicsSubscription = changes.subscribe(GraphicsComponent::type, kinds);
+	}
+
+	GraphicsSync::~GraphicsSync()
+	{
+		this->changes.unsubscribe(this->physicsSubscription);
+		this->changes.unsubscribe(this->graphicsSubscription);
+	}
+
+	void GraphicsSync::setView(const Vec2& min, const Vec2& max, float margin)
+	{
+		this->viewMin = Vec2{ min.x - margin, min.y - margin };
+		this->viewMax = Vec2{ max.x + margin, max.y + margin };
+		this->hasView = true;
+		this->viewChanged = true;
+	}
+
+	void GraphicsSync::clearView()
+	{
+		this->hasView = false;
+		this->viewChanged = true;
+	}
+
+	void GraphicsSync::process()
+	{
+		this->dirty.clear();
+		this->changes.forEachChange(this->physicsSubscription, [this](uint32_t entity, ChangeKind)
+		{
+			this->dirty.emplace_back(entity, MOVED);
+		});
+		this->changes.forEachChange(this->graphicsSubscription, [this](uint32_t entity, ChangeKind)
+		{
+			this->dirty.emplace_back(entity, MOVED | APPEARANCE);
+		});
+		if (this->viewChanged)
+		{
+			// Deferred entities might be in the new view
+			this->dirty.insert(this->dirty.end(), this->deferred.begin(), this->deferred.end());
+			this->deferred.clear();
+			this->viewChanged = false;
+		}
+
+		// Merges the entries of entities that changed more than once
+		std::sort(this->dirty.begin(), this->dirty.end());
+		this->batch.clear();
+		for (uint32_t i = 0; i < this->dirty.size();)
+		{
+			uint32_t entity = this->dirty[i].first;
+			uint8_t flags = 0;
+			for (; i < this->dirty.size() && this->dirty[i].first == entity; ++i)
+			{
+				flags |= this->dirty[i].second;
+			}
+
+			// What changed while it was outside of the view is pushed too
+			auto waiting = this->deferred.find(entity);
+			if (waiting != this->deferred.end())
+			{
+				flags |= waiting->second;
+				this->deferred.erase(waiting);
+			}
+
+			auto graphics = this->entityManager.getComponent<GraphicsComponent>(entity);
+			if (graphics == nullptr || graphics->node == nullptr)
+			{
+				continue;
+			}
+			if (!graphics->visible)
+			{
+				// Hidden nodes only need to be hidden, their state is pushed once they are shown again
+				if ((flags & APPEARANCE) && graphics->node->isVisible())
+				{
+					graphics->node->setVisible(false);
+				}
+				continue;
+			}
+
+			auto physics = this->entityManager.getComponent<PhysicsComponent>(entity);
+			if (physics != nullptr && !isInView(physics->position))
+			{
+				// Otherwise the node stays drawn where it left the view, it's shown again once it's back
+				if (graphics->node->isVisible())
+				{
+					graphics->node->setVisible(false);
+				}
+				this->deferred[entity] = flags | APPEARANCE;
+				continue;
+			}
+			this->batch.push_back(Update{ graphics->node, entity, flags });
+		}
+
+		std::sort(this->batch.begin(), this->batch.end(), [](const Update& lhs, const Update& rhs)
+		{
+			return std::less<Node*>{}(lhs.node, rhs.node);
+		});
+
+		for (const auto& update : this->batch)
+		{
+			auto physics = this->entityManager.getComponent<PhysicsComponent>(update.entity);
+			if (physics != nullptr)
+			{
+				update.node->setPosition(physics->position);
+			}
+			if (update.flags & APPEARANCE)
+			{
+				auto graphics = this->entityManager.getComponent<GraphicsComponent>(update.entity);
+				update.node->setVisible(true);
+				if (graphics->isManualScaling)
+				{
+					update.node->setScale(graphics->scale.x, graphics->scale.y);
+				}
+				auto sprite = dynamic_cast<Sprite*>(update.node);
+				if (sprite != nullptr && !graphics->sprite.empty())
+				{
+					this->atlas.setSprite(sprite, graphics->sprite);
+				}
+			}
+		}
+		this->syncedCount = (uint32_t)this->batch.size();
+	}
+
+	uint32_t GraphicsSync::getSyncedCount() const
+	{
+		return this->syncedCount;
+	}
+
+	uint32_t GraphicsSync::getDeferredCount() const
+	{
+		return (uint32_t)this->deferred.size();
+	}
+
+	bool GraphicsSync::isInView(const Vec2& position) const
+	{
+		return !this->hasView
+			|| (position.x >= this->viewMin.x && position.y >= this->viewMin.y
+				&& position.x <= this->viewMax.x && position.y <= this->viewMax.y);
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,80 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "math/Vec2.h"
+#include "2d/CCNode.h"
+
+namespace RioGame
+{
+
+	using ::RioEngine::Vec2;
+	using ::RioEngine::Node;
+
+	class EntityManager;
+	class ChangeTracker;
+	class SpriteAtlas;
+
+	// Copies the state of changed entities to their scene nodes once per tick
+	// Only entities whose PhysicsComponent (position) or GraphicsComponent (sprite, scale, visibility)
+	// was reported to the ChangeTracker are looked at, invisible ones are skipped and ones outside
+	// of the view are hidden and deferred until they or the view move. The node updates are applied in one batch
+	// sorted by node address, so the scene graph is walked through memory in order
+	// Sprites are changed through the SpriteAtlas, so sprites in an atlas stay in their page's batch
+	class GraphicsSync
+	{
+	public:
+		GraphicsSync(EntityManager& entityManager, ChangeTracker& changes, SpriteAtlas& atlas);
+		GraphicsSync(const GraphicsSync&) = delete;
+		GraphicsSync& operator=(const GraphicsSync&) = delete;
+		~GraphicsSync();
+
+		// World rectangle outside of which nodes aren't updated, margin is added on all sides
+		void setView(const Vec2& min, const Vec2& max, float margin = 2.0f);
+		void clearView();
+		void process();
+
+		// Amount of nodes updated by the last process call
+		uint32_t getSyncedCount() const;
+		// Amount of changed entities waiting outside of the view
+		uint32_t getDeferredCount() const;
+	private:
+		enum Flags : uint8_t
+		{
+			MOVED = 1 << 0,
+			APPEARANCE = 1 << 1
+		};
+
+		struct Update
+		{
+			Node* node;
+			uint32_t entity;
+			uint8_t flags;
+		};
+
+		bool isInView(const Vec2& position) const;
+
+		EntityManager& entityManager;
+		ChangeTracker& changes;
+		SpriteAtlas& atlas;
+		uint32_t physicsSubscription;
+		uint32_t graphicsSubscription;
+
+		// Changed entities and what changed about them, reused every tick
+		std::vector<std::pair<uint32_t, uint8_t>> dirty;
+		std::vector<Update> batch;
+		std::unordered_map<uint32_t, uint8_t> deferred;
+
+		bool hasView = false;
+		bool viewChanged = false;
+		Vec2 viewMin;
+		Vec2 viewMax;
+		uint32_t syncedCount = 0;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,210 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "GroupCommandPlanner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+#include "base/Macros.h" // for RioAssert
+
+#include "Components.h"
+#include "EntityManager.h"
+#include "World.h"
+
+namespace RioGame
+{
+
+	namespace
+	{
+		TaskType getTaskType(CommandType command, uint32_t target)
+		{
+			if (target == Component::NO_ENTITY)
+			{
+				return TaskType::GO_TO;
+			}
+
+			switch (command)
+			{
+			case CommandType::MINE:
+				return TaskType::GO_PICK_UP_GOLD;
+			case CommandType::ATTACK:
+				return TaskType::GO_KILL;
+			case CommandType::RETURN_GOLD:
+				return TaskType::GO_DEPOSIT_GOLD;
+			default:
+				return TaskType::GO_TO;
+			}
+		}
+	}
+
+	GroupCommandPlanner::GroupCommandPlanner(World& world)
+		: world{ world }
+	{
+	}
+
+	uint32_t GroupCommandPlanner::command(const std::vector<uint32_t>& selection, CommandType command, uint32_t goal, uint32_t target)
+	{
+		EntityManager& entityManager = this->world.getEntityManager();
+		auto goalNode = entityManager.getComponent<GridNodeComponent>(goal);
+		if (goalNode == nullptr)
+		{
+			return 0;
+		}
+
+		this->members.clear();
+		int64_t sumX = 0;
+		int64_t sumY = 0;
+		for (uint32_t entity : selection)
+		{
+			auto commands = entityManager.getComponent<CommandComponent>(entity);
+			if (commands == nullptr || !commands->possibleCommandList.test((uint32_t)command)
+				|| !entityManager.hasComponent<TaskHandlerComponent>(entity))
+			{
+				continue;
+			}
+			// The node the unit stands on
+			auto pathfinding = entityManager.getComponent<PathfindingComponent>(entity);
+			auto node = pathfinding != nullptr ? entityManager.getComponent<GridNodeComponent>(pathfinding->lastId) : nullptr;
+			if (node == nullptr)
+			{
+				continue;
+			}
+
+			this->members.push_back(Member{ entity, pathfinding->lastId, (int32_t)node->x, (int32_t)node->y });
+			sumX += node->x;
+			sumY += node->y;
+		}
+		if (this->members.empty())
+		{
+			return 0;
+		}
+
+		findPlaces(goal, (uint32_t)this->members.size());
+		// More units than free nodes around the goal, the last ones queue up at the goal itself
+		while (this->places.size() < this->members.size())
+		{
+			this->places.push_back(Place{ goal, (int32_t)goalNode->x, (int32_t)goalNode->y });
+		}
+
+		int32_t centerX = (int32_t)(sumX / (int64_t)this->members.size());
+		int32_t centerY = (int32_t)(sumY / (int64_t)this->members.size());
+		float directionX = (float)((int32_t)goalNode->x - centerX);
+		float directionY = (float)((int32_t)goalNode->y - centerY);
+		float length = std::sqrt(directionX * directionX + directionY * directionY);
+		if (length > 0.0f)
+		{
+			directionX /= length;
+			directionY /= length;
+		}
+		else
+		{
+			directionY = 1.0f;
+		}
+		sortIntoRows(this->members, directionX, directionY, centerX, centerY);
+		sortIntoRows(this->places, directionX, directionY, (int32_t)goalNode->x, (int32_t)goalNode->y);
+
+		// The unit closest to the center leads, the search starts at its node
+		auto leader = std::min_element(this->members.begin(), this->members.end(), [centerX, centerY](const Member& lhs, const Member& rhs)
+		{
+			return std::abs(lhs.x - centerX) + std::abs(lhs.y - centerY) < std::abs(rhs.x - centerX) + std::abs(rhs.y - centerY);
+		});
+		uint32_t leaderIndex = (uint32_t)(leader - this->members.begin());
+
+		this->entities.clear();
+		this->starts.clear();
+		this->ends.clear();
+		auto& tasks = entityManager.getComponentContainer<TaskComponent>();
+		tasks.reserve(tasks.size() + this->members.size());
+		TaskType taskType = getTaskType(command, target);
+		for (uint32_t i = 0; i < this->members.size(); ++i)
+		{
+			// Leader first
+			uint32_t index = i == 0 ? leaderIndex : (i == leaderIndex ? 0 : i);
+			const Member& member = this->members[index];
+			this->entities.push_back(member.entity);
+			this->starts.push_back(member.start);
+			this->ends.push_back(this->places[index].node);
+
+			// Tasks given before are dropped, the running one is finished by the TaskSystem
+			auto handler = entityManager.getComponent<TaskHandlerComponent>(member.entity);
+			for (uint32_t task : handler->taskQueue)
+			{
+				this->world.destroyEntity(task);
+			}
+			handler->taskQueue.clear();
+			auto current = entityManager.getComponent<TaskComponent>(handler->currentTask);
+			if (current != nullptr)
+			{
+				current->complete = true;
+			}
+
+			// Going to the place comes first, the task about the target follows from there
+			uint32_t goTo = entityManager.createEntity();
+			this->world.addComponent<TaskComponent>(goTo, TaskComponent{ this->places[index].node, member.entity, TaskType::GO_TO });
+			handler->taskQueue.push_back(goTo);
+			if (taskType != TaskType::GO_TO)
+			{
+				uint32_t task = entityManager.createEntity();
+				this->world.addComponent<TaskComponent>(task, TaskComponent{ target, member.entity, taskType });
+				handler->taskQueue.push_back(task);
+			}
+		}
+
+		this->world.getPathRequestQueue().requestGroup(this->entities.data(), this->starts.data(), this->ends.data()
+			, (uint32_t)this->entities.size(), goal);
+		return (uint32_t)this->members.size();
+	}
+
+	void GroupCommandPlanner::findPlaces(uint32_t goal, uint32_t count)
+	{
+		EntityManager& entityManager = this->world.getEntityManager();
+		OccupancyMap& occupancy = this->world.getOccupancyMap();
+		this->places.clear();
+		this->visited.clear();
+		std::unordered_set<uint32_t> seen{ goal };
+		this->visited.push_back(goal);
+
+		// Breadth first, the visited vector doubles as the queue
+		for (uint32_t i = 0; i < this->visited.size() && this->places.size() < count; ++i)
+		{
+			// The goal is often not walkable (a gold mine, an enemy building), the places are around it anyway
+			auto node = entityManager.getComponent<GridNodeComponent>(this->visited[i]);
+			if (node == nullptr || (!node->free && this->visited[i] != goal))
+			{
+				continue;
+			}
+
+			RioAssert(node->x < occupancy.getWidth() && node->y < occupancy.getHeight(), "Occupancy map not built for the level");
+			if (node->free && occupancy.isFree(node->x, node->y))
+			{
+				this->places.push_back(Place{ this->visited[i], (int32_t)node->x, (int32_t)node->y });
+			}
+			// Portals lead elsewhere, a formation stays on this side
+			for (uint32_t direction = 0; direction < Direction::PORTAL; ++direction)
+			{
+				uint32_t neighbour = node->neighbours[direction];
+				if (neighbour != Component::NO_ENTITY && seen.insert(neighbour).second)
+				{
+					this->visited.push_back(neighbour);
+				}
+			}
+		}
+	}
+
+	template<typename T>
+	void GroupCommandPlanner::sortIntoRows(std::vector<T>& items, float directionX, float directionY, int32_t originX, int32_t originY) const
+	{
+		auto forward = [=](const T& item) { return (item.x - originX) * directionX + (item.y - originY) * directionY; };
+		auto sideways = [=](const T& item) { return (item.x - originX) * directionY - (item.y - originY) * directionX; };
+
+		std::sort(items.begin(), items.end(), [&](const T& lhs, const T& rhs) { return forward(lhs) > forward(rhs); });
+		uint32_t rowLength = (uint32_t)std::ceil(std::sqrt((float)items.size()));
+		for (uint32_t row = 0; row < items.size(); row += rowLength)
+		{
+			auto end = items.begin() + std::min<size_t>(row + rowLength, items.size());
+			std::sort(items.begin() + row, end, [&](const T& lhs, const T& rhs) { return sideways(lhs) < sideways(rhs); });
+		}
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,62 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Enums.h"
+
+namespace RioGame
+{
+
+	class World;
+
+	// Executes a command given to a selected group of units at once
+	// Units that accept the command (CommandComponent::possibleCommandList) get a formation place
+	// around the goal: the free nodes closest to the goal (found by a breadth first search, so the
+	// places are reachable and don't lie behind walls), assigned so that units at the front of the
+	// group take the front places. The whole group shares one path search (PathRequestQueue::requestGroup)
+	// that ends at each unit's place, and the units' tasks are replaced in one pass
+	class GroupCommandPlanner
+	{
+	public:
+		explicit GroupCommandPlanner(World& world);
+		GroupCommandPlanner(const GroupCommandPlanner&) = delete;
+		GroupCommandPlanner& operator=(const GroupCommandPlanner&) = delete;
+
+		// goal is a grid node, target the entity the command is about (the enemy to ATTACK, the gold to MINE
+		// or the storage for RETURN_GOLD) or Component::NO_ENTITY. Returns the amount of units commanded
+		uint32_t command(const std::vector<uint32_t>& selection, CommandType command, uint32_t goal, uint32_t target);
+	private:
+		struct Member
+		{
+			uint32_t entity;
+			uint32_t start;
+			int32_t x;
+			int32_t y;
+		};
+
+		struct Place
+		{
+			uint32_t node;
+			int32_t x;
+			int32_t y;
+		};
+
+		// Collects up to count free nodes around the goal, closest first
+		void findPlaces(uint32_t goal, uint32_t count);
+		// Orders members and places front to back in rows, so the i-th member takes the i-th place
+		template<typename T>
+		void sortIntoRows(std::vector<T>& items, float directionX, float directionY, int32_t originX, int32_t originY) const;
+
+		World& world;
+		std::vector<Member> members;
+		std::vector<Place> places;
+		std::vector<uint32_t> visited;
+		std::vector<uint32_t> entities;
+		std::vector<uint32_t> starts;
+		std::vector<uint32_t> ends;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,157 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "HealthPass.h"
+
+#include <algorithm>
+
+#if defined(__SSE4_1__) || defined(__AVX__)
+#include <smmintrin.h>
+#define RIO_HEALTH_PASS_SSE 1
+#else
+#define RIO_HEALTH_PASS_SSE 0
+#endif
+
+#include "Components.h"
+#include "EntityManager.h"
+#include "ChangeTracker.h"
+#include "Tools/ThreadPool.h"
+
+namespace RioGame
+{
+
+	namespace
+	{
+		// Entities per job, the kernel is cheap so jobs have to be large to pay off
+		const uint32_t grain = 4096;
+	}
+
+	template<typename T>
+	void HealthPass::Batch<T>::clear()
+	{
+		this->components.clear();
+		this->entities.clear();
+		this->current.clear();
+		this->maximum.clear();
+		this->regen.clear();
+	}
+
+	HealthPass::HealthPass(EntityManager& entityManager, ThreadPool& threadPool, ChangeTracker& changes)
+		: entityManager{ entityManager }
+		, threadPool{ threadPool }
+		, changes{ changes }
+	{
+	}
+
+	void HealthPass::process(bool regenTick)
+	{
+		this->deaths.clear();
+		this->health.clear();
+		for (auto& pair : this->entityManager.getComponentContainer<HealthComponent>())
+		{
+			HealthComponent& component = pair.second;
+			if (!component.alive)
+			{
+				continue;
+			}
+
+			if (component.currentHealthPoints == 0)
+			{
+				// Dead entities don't regenerate
+				component.alive = false;
+				auto experience = this->entityManager.getComponent<ExperienceValueComponent>(pair.first);
+				this->deaths.push_back(Death{ pair.first, experience != nullptr ? experience->value : 0 });
+				this->changes.markChanged<HealthComponent>(pair.first);
+			}
+			else if (regenTick && component.regen > 0)
+			{
+				this->health.components.push_back(&component);
+				this->health.entities.push_back(pair.first);
+				this->health.current.push_back(component.currentHealthPoints);
+				this->health.maximum.push_back(component.maxHealthPoints);
+				this->health.regen.push_back(component.regen);
+			}
+		}
+		std::sort(this->deaths.begin(), this->deaths.end()
+			, [](const Death& lhs, const Death& rhs) { return lhs.entity < rhs.entity; });
+
+		if (!regenTick)
+		{
+			return;
+		}
+
+		this->mana.clear();
+		for (auto& pair : this->entityManager.getComponentContainer<ManaComponent>())
+		{
+			ManaComponent& component = pair.second;
+			if (component.manaRegen > 0)
+			{
+				this->mana.components.push_back(&component);
+				this->mana.entities.push_back(pair.first);
+				this->mana.current.push_back(component.currentMana);
+				this->mana.maximum.push_back(component.maxMana);
+				this->mana.regen.push_back(component.manaRegen);
+			}
+		}
+
+		regenerate(this->health);
+		regenerate(this->mana);
+
+		// Only the values that changed are written back (full pools are skipped)
+		for (uint32_t i = 0; i < this->health.components.size(); ++i)
+		{
+			if (this->health.components[i]->currentHealthPoints != this->health.current[i])
+			{
+				this->health.components[i]->currentHealthPoints = this->health.current[i];
+				this->changes.markChanged<HealthComponent>(this->health.entities[i]);
+			}
+		}
+		for (uint32_t i = 0; i < this->mana.components.size(); ++i)
+		{
+			if (this->mana.components[i]->currentMana != this->mana.current[i])
+			{
+				this->mana.components[i]->currentMana = this->mana.current[i];
+				this->changes.markChanged<ManaComponent>(this->mana.entities[i]);
+			}
+		}
+	}
+
+	const std::vector<HealthPass::Death>& HealthPass::getDeaths() const
+	{
+		return this->deaths;
+	}
+
+	template<typename T>
+	void HealthPass::regenerate(Batch<T>& batch)
+	{
+		uint32_t* current = batch.current.data();
+		const uint32_t* maximum = batch.maximum.data();
+		const uint32_t* regen = batch.regen.data();
+		this->threadPool.parallelFor((uint32_t)batch.current.size(), grain, [=](uint32_t begin, uint32_t end, uint32_t)
+		{
+			regenerate(current + begin, maximum + begin, regen + begin, end - begin);
+		});
+	}
+
+	void HealthPass::regenerate(uint32_t* current, const uint32_t* maximum, const uint32_t* regen, uint32_t count)
+	{
+		uint32_t i = 0;
+#if RIO_HEALTH_PASS_SSE
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128i value = _mm_loadu_si128((const __m128i*)(current + i));
+			__m128i limit = _mm_loadu_si128((const __m128i*)(maximum + i));
+			__m128i amount = _mm_loadu_si128((const __m128i*)(regen + i));
+			// Adding at most the headroom can't overflow
+			value = _mm_min_epu32(value, limit);
+			amount = _mm_min_epu32(amount, _mm_sub_epi32(limit, value));
+			_mm_storeu_si128((__m128i*)(current + i), _mm_add_epi32(value, amount));
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			uint32_t value = std::min(current[i], maximum[i]);
+			current[i] = value + std::min(regen[i], maximum[i] - value);
+		}
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
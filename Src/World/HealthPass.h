@@ -0,0 +1,67 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace RioGame
+{
+
+	class EntityManager;
+	class ThreadPool;
+	class ChangeTracker;
+	struct HealthComponent;
+	struct ManaComponent;
+
+	// Regeneration and death detection of all entities in one batch
+	// The health (and on regen ticks the mana) of all living entities is gathered into contiguous
+	// arrays, regenerated with saturating adds in parallel and written back, entities whose health
+	// dropped to zero since the last pass are collected in a compact list
+	class HealthPass
+	{
+	public:
+		struct Death
+		{
+			uint32_t entity;
+			// ExperienceValueComponent::value of the entity or 0
+			uint32_t experience;
+		};
+
+		HealthPass(EntityManager& entityManager, ThreadPool& threadPool, ChangeTracker& changes);
+		HealthPass(const HealthPass&) = delete;
+		HealthPass& operator=(const HealthPass&) = delete;
+
+		// Collects the newly dead entities (and marks them as not alive), regenerates if regenTick is set
+		void process(bool regenTick);
+		// Entities that died in the last process call, sorted by id
+		const std::vector<Death>& getDeaths() const;
+
+		// current[i] = min(current[i] + regen[i], maximum[i]), without overflowing
+		static void regenerate(uint32_t* current, const uint32_t* maximum, const uint32_t* regen, uint32_t count);
+	private:
+		// Gathered values of one component type, ordered like the component pointers
+		template<typename T>
+		struct Batch
+		{
+			std::vector<T*> components;
+			std::vector<uint32_t> entities;
+			std::vector<uint32_t> current;
+			std::vector<uint32_t> maximum;
+			std::vector<uint32_t> regen;
+
+			void clear();
+		};
+
+		template<typename T>
+		void regenerate(Batch<T>& batch);
+
+		EntityManager& entityManager;
+		ThreadPool& threadPool;
+		ChangeTracker& changes;
+		Batch<HealthComponent> health;
+		Batch<ManaComponent> mana;
+		std::vector<Death> deaths;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,239 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "OccupancyMap.h"
+
+#include <algorithm>
+
+#include "base/Macros.h" // for RioAssert
+
+#include "Components.h"
+#include "EntityManager.h"
+
+namespace RioGame
+{
+
+	constexpr uint32_t OccupancyMap::NO_ENTITY;
+
+	void OccupancyMap::resize(uint32_t width, uint32_t height, bool walls)
+	{
+		this->width = width;
+		this->height = height;
+		this->counts.assign(width * height, 0);
+		this->walls.assign(width * height, walls ? 1 : 0);
+		this->reservations.assign(width * height, NO_ENTITY);
+		this->reservedCells.clear();
+		this->tree.assign(width * height, 0);
+		if (walls)
+		{
+			buildTree();
+		}
+	}
+
+	void OccupancyMap::build(EntityManager& entityManager)
+	{
+		const auto& nodes = entityManager.getComponentContainer<GridNodeComponent>();
+		uint32_t maxX = 0;
+		uint32_t maxY = 0;
+		for (const auto& pair : nodes)
+		{
+			maxX = std::max(maxX, pair.second.x + 1);
+			maxY = std::max(maxY, pair.second.y + 1);
+		}
+
+		resize(maxX, maxY);
+		for (const auto& pair : nodes)
+		{
+			const GridNodeComponent& node = pair.second;
+			uint32_t index = getIndex(node.x, node.y);
+			this->walls[index] = node.free ? 0 : 1;
+			if (node.resident != Component::NO_ENTITY)
+			{
+				++this->counts[index];
+			}
+		}
+		buildTree();
+	}
+
+	void OccupancyMap::setWall(uint32_t x, uint32_t y, bool wall)
+	{
+		uint32_t index = getIndex(x, y);
+		bool wasBusy = isBusy(index);
+		this->walls[index] = wall ? 1 : 0;
+		updateBusy(index, wasBusy);
+	}
+
+	void OccupancyMap::occupy(uint32_t x, uint32_t y)
+	{
+		uint32_t index = getIndex(x, y);
+		RioAssert(this->counts[index] < 0xFFFF, "Too many occupants in one cell");
+		bool wasBusy = isBusy(index);
+		++this->counts[index];
+		updateBusy(index, wasBusy);
+	}
+
+	void OccupancyMap::vacate(uint32_t x, uint32_t y)
+	{
+		uint32_t index = getIndex(x, y);
+		RioAssert(this->counts[index] > 0, "Vacating an empty cell");
+		bool wasBusy = isBusy(index);
+		--this->counts[index];
+		updateBusy(index, wasBusy);
+	}
+
+	bool OccupancyMap::reserve(uint32_t entity, uint32_t x, uint32_t y)
+	{
+		uint32_t index = getIndex(x, y);
+		if (this->reservations[index] == entity)
+		{
+			return true;
+		}
+		if (this->walls[index] != 0 || this->counts[index] != 0 || this->reservations[index] != NO_ENTITY)
+		{
+			return false;
+		}
+
+		release(entity);
+		this->reservations[index] = entity;
+		this->reservedCells[entity] = index;
+		updateBusy(index, false);
+		return true;
+	}
+
+	void OccupancyMap::release(uint32_t entity)
+	{
+		auto it = this->reservedCells.find(entity);
+		if (it == this->reservedCells.end())
+		{
+			return;
+		}
+
+		this->reservations[it->second] = NO_ENTITY;
+		updateBusy(it->second, true);
+		this->reservedCells.erase(it);
+	}
+
+	bool OccupancyMap::isFree(uint32_t x, uint32_t y, uint32_t entity) const
+	{
+		uint32_t index = getIndex(x, y);
+		return this->walls[index] == 0 && this->counts[index] == 0
+			&& (this->reservations[index] == NO_ENTITY || this->reservations[index] == entity);
+	}
+
+	uint32_t OccupancyMap::getOccupantCount(uint32_t x, uint32_t y) const
+	{
+		return this->counts[getIndex(x, y)];
+	}
+
+	uint32_t OccupancyMap::getReservation(uint32_t x, uint32_t y) const
+	{
+		return this->reservations[getIndex(x, y)];
+	}
+
+	bool OccupancyMap::isAreaFree(uint32_t x, uint32_t y, uint32_t width, uint32_t height) const
+	{
+		if (x + width > this->width || y + height > this->height || x + width < x || y + height < y)
+		{
+			return false;
+		}
+
+		// Unsigned wrap around cancels out in the sum
+		uint32_t busy = countBusy(x + width, y + height) - countBusy(x, y + height)
+			- countBusy(x + width, y) + countBusy(x, y);
+		return busy == 0;
+	}
+
+	bool OccupancyMap::canPlace(uint32_t centerX, uint32_t centerY, uint32_t radius) const
+	{
+		if (centerX < radius || centerY < radius)
+		{
+			return false;
+		}
+		return isAreaFree(centerX - radius, centerY - radius, 2 * radius + 1, 2 * radius + 1);
+	}
+
+	uint32_t OccupancyMap::getWidth() const
+	{
+		return this->width;
+	}
+
+	uint32_t OccupancyMap::getHeight() const
+	{
+		return this->height;
+	}
+
+	uint32_t OccupancyMap::getIndex(uint32_t x, uint32_t y) const
+	{
+		RioAssert(x < this->width && y < this->height, "Cell outside of the occupancy map");
+		return y * this->width + x;
+	}
+
+	bool OccupancyMap::isBusy(uint32_t index) const
+	{
+		return this->walls[index] != 0 || this->counts[index] != 0 || this->reservations[index] != NO_ENTITY;
+	}
+
+	void OccupancyMap::updateBusy(uint32_t index, bool wasBusy)
+	{
+		bool busy = isBusy(index);
+		if (busy == wasBusy)
+		{
+			return;
+		}
+
+		uint32_t delta = busy ? 1 : uint32_t(-1);
+		for (uint32_t y = index / this->width + 1; y <= this->height; y += y & (0 - y))
+		{
+			for (uint32_t x = index % this->width + 1; x <= this->width; x += x & (0 - x))
+			{
+				this->tree[(y - 1) * this->width + x - 1] += delta;
+			}
+		}
+	}
+
+	void OccupancyMap::buildTree()
+	{
+		for (uint32_t index = 0; index < this->tree.size(); ++index)
+		{
+			this->tree[index] = isBusy(index) ? 1 : 0;
+		}
+		// The dimensions are independent, every row is built as a one dimensional tree, then every column
+		for (uint32_t y = 0; y < this->height; ++y)
+		{
+			uint32_t* row = &this->tree[y * this->width];
+			for (uint32_t x = 1; x <= this->width; ++x)
+			{
+				uint32_t parent = x + (x & (0 - x));
+				if (parent <= this->width)
+				{
+					row[parent - 1] += row[x - 1];
+				}
+			}
+		}
+		for (uint32_t y = 1; y <= this->height; ++y)
+		{
+			uint32_t parent = y + (y & (0 - y));
+			if (parent > this->height)
+			{
+				continue;
+			}
+			for (uint32_t x = 0; x < this->width; ++x)
+			{
+				this->tree[(parent - 1) * this->width + x] += this->tree[(y - 1) * this->width + x];
+			}
+		}
+	}
+
+	uint32_t OccupancyMap::countBusy(uint32_t x, uint32_t y) const
+	{
+		uint32_t count = 0;
+		for (uint32_t row = y; row > 0; row -= row & (0 - row))
+		{
+			for (uint32_t column = x; column > 0; column -= column & (0 - column))
+			{
+				count += this->tree[(row - 1) * this->width + column - 1];
+			}
+		}
+		return count;
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
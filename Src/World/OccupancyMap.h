@@ -0,0 +1,71 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace RioGame
+{
+
+	class EntityManager;
+
+	// Occupancy layer of the grid, one entry per cell instead of the single GridNodeComponent::resident
+	// Keeps the amount of units and structures in every cell, walls, and the cell each unit claimed
+	// for its next step. A two dimensional Fenwick tree counts the busy cells, so a cell changing
+	// and "is this rectangle empty" both cost O(log width * log height)
+	class OccupancyMap
+	{
+	public:
+		static constexpr uint32_t NO_ENTITY = uint32_t(-1);
+
+		// All cells start empty, or as walls for cells whose nodes come later (paged in chunks)
+		void resize(uint32_t width, uint32_t height, bool walls = false);
+		// Reads walls (nodes that aren't free) and residents from all GridNodeComponents
+		void build(EntityManager& entityManager);
+
+		void setWall(uint32_t x, uint32_t y, bool wall);
+		// A unit or a building's footprint cell entering or leaving the cell
+		void occupy(uint32_t x, uint32_t y);
+		void vacate(uint32_t x, uint32_t y);
+		// Claims the cell for the entity's next step, replacing the entity's previous claim
+		// Returns false if the cell is a wall, occupied or claimed by someone else
+		bool reserve(uint32_t entity, uint32_t x, uint32_t y);
+		// Drops the entity's claim (after it arrived or gave up)
+		void release(uint32_t entity);
+
+		// True if the entity may step into the cell
+		bool isFree(uint32_t x, uint32_t y, uint32_t entity = NO_ENTITY) const;
+		uint32_t getOccupantCount(uint32_t x, uint32_t y) const;
+		uint32_t getReservation(uint32_t x, uint32_t y) const;
+		// True if no cell of the rectangle is a wall, occupied or claimed, cells outside of the map count as walls
+		bool isAreaFree(uint32_t x, uint32_t y, uint32_t width, uint32_t height) const;
+		// Same for the (2 * radius + 1)^2 footprint of a building with a StructureComponent::radius
+		bool canPlace(uint32_t centerX, uint32_t centerY, uint32_t radius) const;
+
+		uint32_t getWidth() const;
+		uint32_t getHeight() const;
+	private:
+		uint32_t getIndex(uint32_t x, uint32_t y) const;
+		bool isBusy(uint32_t index) const;
+		// Updates the tree if the cell became busy or stopped being busy
+		void updateBusy(uint32_t index, bool wasBusy);
+		// Builds the tree from all cells at once
+		void buildTree();
+		// Amount of busy cells in the rectangle from (0, 0) to (x, y), both exclusive
+		uint32_t countBusy(uint32_t x, uint32_t y) const;
+
+		uint32_t width = 0;
+		uint32_t height = 0;
+		std::vector<uint16_t> counts;
+		std::vector<uint8_t> walls;
+		// Entity that claimed the cell, NO_ENTITY if nobody did
+		std::vector<uint32_t> reservations;
+		std::unordered_map<uint32_t, uint32_t> reservedCells;
+		// Fenwick tree of the busy cells, width x height, entry (x, y) covers the cells
+		// (x - lowbit(x + 1), x] x (y - lowbit(y + 1), y]
+		std::vector<uint32_t> tree;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,480 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "PathRequestQueue.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include "EntityManager.h"
+#include "ChangeTracker.h"
+
+namespace RioGame
+{
+
+	namespace
+	{
+		constexpr uint32_t NO_NODE = uint32_t(-1);
+		constexpr uint32_t NO_GROUP = uint32_t(-1);
+		constexpr float diagonalCost = 1.41421356f;
+		// Nodes a unit may look at to find its way onto a shared path
+		constexpr uint32_t maxConnectorNodes = 1024;
+	}
+
+	PathRequestQueue::PathRequestQueue(EntityManager& entityManager, ChangeTracker& changes, ThreadPool& threadPool
+		, LinearArena& frameArena, ThreadArenas& threadArenas)
+		: entityManager(entityManager)
+		, changes(changes)
+		, threadPool(threadPool)
+		, frameArena(frameArena)
+		, threadArenas(threadArenas)
+		, nodeChanges{ changes.subscribe(GridNodeComponent::type, (uint8_t)ChangeKind::ALL) }
+		, scratches(threadPool.getThreadCount())
+	{
+	}
+
+	PathRequestQueue::~PathRequestQueue()
+	{
+		this->threadPool.wait(this->running);
+	}
+
+	void PathRequestQueue::request(uint32_t entity, uint32_t start, uint32_t goal, bool near)
+	{
+		uint32_t ticket = this->nextTicket++;
+		this->tickets[entity] = ticket;
+		this->queued.push_back(Request{ entity, start, goal, ticket, NO_GROUP, NO_NODE, near, false });
+	}
+
+	void PathRequestQueue::requestGroup(const uint32_t* entities, const uint32_t* starts, const uint32_t* ends, uint32_t count, uint32_t goal)
+	{
+		uint32_t group = this->nextGroup++;
+		this->queued.reserve(this->queued.size() + count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			uint32_t ticket = this->nextTicket++;
+			this->tickets[entities[i]] = ticket;
+			this->queued.push_back(Request{ entities[i], starts[i], goal, ticket, group, ends[i], false, false });
+		}
+	}
+
+	void PathRequestQueue::requestAlone(const Request& request, uint32_t goal)
+	{
+		// The new ticket drops the result of the shared search
+		uint32_t ticket = this->nextTicket++;
+		this->tickets[request.entity] = ticket;
+		this->queued.push_back(Request{ request.entity, this->graph.ids[request.start], this->graph.ids[goal]
+			, ticket, NO_GROUP, NO_NODE, request.near, true });
+	}
+
+	void PathRequestQueue::deliver()
+	{
+		this->threadPool.wait(this->running);
+
+		for (auto& job : this->jobs)
+		{
+			for (size_t r = 0; r < job.requests.size(); ++r)
+			{
+				const Request& request = job.requests[r];
+				auto ticket = this->tickets.find(request.entity);
+				if (ticket == this->tickets.end() || ticket->second != request.ticket)
+				{
+					// A newer request of the same entity is still waiting
+					continue;
+				}
+				this->tickets.erase(ticket);
+
+				auto pathfinding = this->entityManager.getComponent<PathfindingComponent>(request.entity);
+				if (pathfinding == nullptr)
+				{
+					continue;
+				}
+
+				pathfinding->pathQueue.clear();
+				pathfinding->targetId = this->graph.ids[request.end != NO_NODE ? request.end : job.goal];
+				if (!job.found)
+				{
+					// A cluster can straddle a wall, the goal might still be reachable from the request's own start,
+					// and a group's places might be reachable when its goal isn't
+					if (!request.alone && (request.group != NO_GROUP || request.start != job.start))
+					{
+						requestAlone(request, request.end != NO_NODE ? request.end : job.goal);
+					}
+					continue;
+				}
+
+				// Units sharing the search walk onto the path first
+				const Connection& connection = job.connections[r];
+				if (!connection.reachable)
+				{
+					requestAlone(request, request.end != NO_NODE ? request.end : job.goal);
+					continue;
+				}
+
+				for (uint32_t i = connection.joinBegin; i < connection.joinEnd; ++i)
+				{
+					pathfinding->pathQueue.push_back(this->graph.ids[job.connectors[i]]);
+				}
+				for (uint32_t i = connection.first; i < connection.last; ++i)
+				{
+					pathfinding->pathQueue.push_back(this->graph.ids[job.path[i]]);
+				}
+				// and units of a formation walk off it to their place
+				for (uint32_t i = connection.leaveBegin; i < connection.leaveEnd; ++i)
+				{
+					pathfinding->pathQueue.push_back(this->graph.ids[job.connectors[i]]);
+				}
+			}
+		}
+		this->jobs.clear();
+	}
+
+	void PathRequestQueue::dispatch()
+	{
+		if (!this->running.isDone() || !this->jobs.empty())
+		{
+			deliver();
+		}
+
+		// Nodes that were added, removed or changed their free state
+		this->changes.forEachChange(this->nodeChanges, [this](uint32_t, ChangeKind) { this->graphDirty = true; });
+
+		if (this->queued.empty())
+		{
+			return;
+		}
+
+		if (this->graphDirty)
+		{
+			rebuildGraph();
+		}
+
+		using JobIndices = std::unordered_map<uint64_t, uint32_t, std::hash<uint64_t>, std::equal_to<uint64_t>
+			, ArenaAllocator<std::pair<const uint64_t, uint32_t>>>;
+		JobIndices jobIndices{ this->queued.size(), std::hash<uint64_t>{}, std::equal_to<uint64_t>{}
+			, ArenaAllocator<std::pair<const uint64_t, uint32_t>>{ &this->frameArena } };
+		for (auto& request : this->queued)
+		{
+			auto start = this->graph.indices.find(request.start);
+			auto goal = this->graph.indices.find(request.goal);
+			if (start == this->graph.indices.end() || goal == this->graph.indices.end())
+			{
+				// Not a grid node, the request can't be answered
+				auto ticket = this->tickets.find(request.entity);
+				if (ticket != this->tickets.end() && ticket->second == request.ticket)
+				{
+					this->tickets.erase(ticket);
+				}
+				continue;
+			}
+
+			request.start = start->second;
+			request.goal = goal->second;
+			if (request.end != NO_NODE)
+			{
+				auto end = this->graph.indices.find(request.end);
+				request.end = end != this->graph.indices.end() ? end->second : NO_NODE;
+			}
+
+			uint64_t key;
+			if (request.alone)
+			{
+				key = ((uint64_t)1 << 61) | request.ticket;
+			}
+			else if (request.group != NO_GROUP)
+			{
+				// The search starts where the first request of the group starts
+				key = ((uint64_t)1 << 62) | request.group;
+			}
+			else
+			{
+				uint64_t cluster = (uint64_t)(this->graph.x[request.start] / clusterSize)
+					| ((uint64_t)(this->graph.y[request.start] / clusterSize) << 14);
+				key = ((uint64_t)request.near << 63) | (cluster << 32) | request.goal;
+			}
+
+			auto job = jobIndices.find(key);
+			if (job == jobIndices.end())
+			{
+				job = jobIndices.emplace(key, (uint32_t)this->jobs.size()).first;
+				this->jobs.push_back(Job{ request.start, request.goal, request.near
+					, ArenaVector<Request>{ ArenaAllocator<Request>{ &this->frameArena } }
+					, ArenaVector<uint32_t>{}, ArenaVector<Connection>{}, ArenaVector<uint32_t>{} });
+			}
+			this->jobs[job->second].requests.push_back(request);
+		}
+		this->queued.clear();
+
+		for (auto& job : this->jobs)
+		{
+			Job* jobPointer = &job;
+			this->threadPool.submitBackground(this->running, [this, jobPointer](uint32_t thread) {
+				solve(*jobPointer, this->scratches[thread], this->threadArenas.get(thread));
+			});
+		}
+	}
+
+	void PathRequestQueue::invalidateGraph()
+	{
+		this->graphDirty = true;
+	}
+
+	uint32_t PathRequestQueue::getQueuedCount() const
+	{
+		return (uint32_t)this->queued.size();
+	}
+
+	void PathRequestQueue::rebuildGraph()
+	{
+		Graph& graph = this->graph;
+		graph = Graph{};
+
+		auto& nodes = this->entityManager.getComponentContainer<GridNodeComponent>();
+		graph.ids.reserve(nodes.size());
+		for (auto& node : nodes)
+		{
+			graph.indices.emplace(node.first, (uint32_t)graph.ids.size());
+			graph.ids.push_back(node.first);
+		}
+
+		graph.neighbours.resize(graph.ids.size());
+		graph.free.resize(graph.ids.size());
+		graph.x.resize(graph.ids.size());
+		graph.y.resize(graph.ids.size());
+		for (auto& node : nodes)
+		{
+			uint32_t index = graph.indices[node.first];
+			graph.free[index] = node.second.free;
+			graph.x[index] = node.second.x;
+			graph.y[index] = node.second.y;
+
+			for (uint32_t i = 0; i < GridNodeComponent::neighbourCount; ++i)
+			{
+				auto neighbour = graph.indices.find(node.second.neighbours[i]);
+				graph.neighbours[index][i] = neighbour != graph.indices.end() ? neighbour->second : NO_NODE;
+			}
+			graph.hasPortals |= graph.neighbours[index][Direction::PORTAL] != NO_NODE;
+		}
+
+		for (auto& scratch : this->scratches)
+		{
+			scratch.cost.assign(graph.ids.size(), 0.0f);
+			scratch.parent.assign(graph.ids.size(), NO_NODE);
+			scratch.visited.assign(graph.ids.size(), 0);
+			scratch.closed.assign(graph.ids.size(), 0);
+			scratch.stamp = 0;
+			scratch.onPath.assign(graph.ids.size(), 0);
+			scratch.position.assign(graph.ids.size(), 0);
+			scratch.pathMark = 0;
+		}
+		this->graphDirty = false;
+	}
+
+	void PathRequestQueue::solve(Job& job, Scratch& scratch, LinearArena& arena) const
+	{
+		const Graph& graph = this->graph;
+		using OpenNode = std::pair<float, uint32_t>;
+		auto& open = scratch.open;
+		open.clear();
+		uint32_t stamp = ++scratch.stamp;
+
+		scratch.cost[job.start] = 0.0f;
+		scratch.parent[job.start] = NO_NODE;
+		scratch.visited[job.start] = stamp;
+		open.emplace_back(heuristic(job.start, job.goal), job.start);
+
+		bool found = false;
+		while (!open.empty())
+		{
+			std::pop_heap(open.begin(), open.end(), std::greater<OpenNode>{});
+			uint32_t current = open.back().second;
+			open.pop_back();
+
+			if (scratch.closed[current] == stamp)
+			{
+				continue;
+			}
+			scratch.closed[current] = stamp;
+
+			if (current == job.goal)
+			{
+				found = true;
+				break;
+			}
+
+			for (uint32_t direction = 0; direction < GridNodeComponent::neighbourCount; ++direction)
+			{
+				uint32_t neighbour = graph.neighbours[current][direction];
+				if (neighbour == NO_NODE || scratch.closed[neighbour] == stamp
+					|| (!graph.free[neighbour] && neighbour != job.goal))
+				{
+					continue;
+				}
+
+				bool diagonal = direction >= Direction::UP_LEFT && direction <= Direction::DOWN_RIGHT;
+				float cost = scratch.cost[current] + (diagonal ? diagonalCost : 1.0f);
+				if (scratch.visited[neighbour] != stamp || cost < scratch.cost[neighbour])
+				{
+					scratch.visited[neighbour] = stamp;
+					scratch.cost[neighbour] = cost;
+					scratch.parent[neighbour] = current;
+					open.emplace_back(cost + heuristic(neighbour, job.goal), neighbour);
+					std::push_heap(open.begin(), open.end(), std::greater<OpenNode>{});
+				}
+			}
+		}
+
+		ArenaVector<uint32_t> path{ ArenaAllocator<uint32_t>{ &arena } };
+		if (found)
+		{
+			for (uint32_t node = job.goal; node != job.start; node = scratch.parent[node])
+			{
+				path.push_back(node);
+			}
+			std::reverse(path.begin(), path.end());
+
+			if (job.near && !path.empty())
+			{
+				path.pop_back();
+			}
+		}
+		job.path = std::move(path);
+		job.found = found;
+
+		job.connections = ArenaVector<Connection>{ ArenaAllocator<Connection>{ &arena } };
+		job.connectors = ArenaVector<uint32_t>{ ArenaAllocator<uint32_t>{ &arena } };
+		if (!found)
+		{
+			return;
+		}
+
+		// An empty path still has the start (the leader already stands on the goal), the others join it there
+
+		uint32_t mark = ++scratch.pathMark;
+		scratch.onPath[job.start] = mark;
+		scratch.position[job.start] = 0;
+		for (uint32_t i = 0; i < job.path.size(); ++i)
+		{
+			scratch.onPath[job.path[i]] = mark;
+			scratch.position[job.path[i]] = i + 1;
+		}
+
+		job.connections.reserve(job.requests.size());
+		for (const auto& request : job.requests)
+		{
+			Connection connection{};
+			connection.joinBegin = (uint32_t)job.connectors.size();
+			uint32_t join = connect(request.start, 0, true, scratch, job.connectors);
+			connection.joinEnd = (uint32_t)job.connectors.size();
+			connection.leaveBegin = connection.joinEnd;
+			// Units of a formation leave the path where it comes closest to their place, walking from
+			// the place back to the path finds that node, not before the node the unit joined at
+			uint32_t leave = (uint32_t)job.path.size();
+			if (join != NO_NODE && request.end != NO_NODE)
+			{
+				leave = connect(request.end, join, false, scratch, job.connectors);
+			}
+			connection.leaveEnd = (uint32_t)job.connectors.size();
+			// Position p is path[p - 1], the path is followed after the join node up to the leave node
+			connection.first = join;
+			connection.last = leave;
+			connection.reachable = join != NO_NODE && leave != NO_NODE;
+			job.connections.push_back(connection);
+		}
+	}
+
+	uint32_t PathRequestQueue::connect(uint32_t from, uint32_t minPosition, bool toPath
+		, Scratch& scratch, ArenaVector<uint32_t>& connectors) const
+	{
+		const Graph& graph = this->graph;
+		using OpenNode = std::pair<float, uint32_t>;
+		auto& open = scratch.open;
+		open.clear();
+		uint32_t stamp = ++scratch.stamp;
+
+		scratch.cost[from] = 0.0f;
+		scratch.parent[from] = NO_NODE;
+		scratch.visited[from] = stamp;
+		open.emplace_back(0.0f, from);
+
+		// Dijkstra, the closest node of the path is not known up front
+		uint32_t found = NO_NODE;
+		uint32_t expanded = 0;
+		while (!open.empty() && expanded < maxConnectorNodes)
+		{
+			std::pop_heap(open.begin(), open.end(), std::greater<OpenNode>{});
+			uint32_t current = open.back().second;
+			open.pop_back();
+
+			if (scratch.closed[current] == stamp)
+			{
+				continue;
+			}
+			scratch.closed[current] = stamp;
+			++expanded;
+
+			if (scratch.onPath[current] == scratch.pathMark && scratch.position[current] >= minPosition)
+			{
+				found = current;
+				break;
+			}
+
+			for (uint32_t direction = 0; direction < GridNodeComponent::neighbourCount; ++direction)
+			{
+				uint32_t neighbour = graph.neighbours[current][direction];
+				if (neighbour == NO_NODE || scratch.closed[neighbour] == stamp || !graph.free[neighbour])
+				{
+					continue;
+				}
+
+				bool diagonal = direction >= Direction::UP_LEFT && direction <= Direction::DOWN_RIGHT;
+				float cost = scratch.cost[current] + (diagonal ? diagonalCost : 1.0f);
+				if (scratch.visited[neighbour] != stamp || cost < scratch.cost[neighbour])
+				{
+					scratch.visited[neighbour] = stamp;
+					scratch.cost[neighbour] = cost;
+					scratch.parent[neighbour] = current;
+					open.emplace_back(cost, neighbour);
+					std::push_heap(open.begin(), open.end(), std::greater<OpenNode>{});
+				}
+			}
+		}
+
+		if (found == NO_NODE)
+		{
+			return NO_NODE;
+		}
+
+		if (toPath)
+		{
+			size_t begin = connectors.size();
+			for (uint32_t node = found; node != from; node = scratch.parent[node])
+			{
+				connectors.push_back(node);
+			}
+			std::reverse(connectors.begin() + begin, connectors.end());
+		}
+		else if (found != from)
+		{
+			// The node on the path is already walked, the parents lead from it to where the search started
+			for (uint32_t node = scratch.parent[found]; node != NO_NODE; node = scratch.parent[node])
+			{
+				connectors.push_back(node);
+			}
+		}
+		return scratch.position[found];
+	}
+
+	float PathRequestQueue::heuristic(uint32_t from, uint32_t to) const
+	{
+		// Portals can connect distant nodes, the octile distance would overestimate through them
+		if (this->graph.hasPortals)
+		{
+			return 0.0f;
+		}
+
+		float dx = std::abs((float)this->graph.x[from] - (float)this->graph.x[to]);
+		float dy = std::abs((float)this->graph.y[from] - (float)this->graph.y[to]);
+		return std::max(dx, dy) + (diagonalCost - 1.0f) * std::min(dx, dy);
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
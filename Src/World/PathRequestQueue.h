@@ -0,0 +1,164 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Components.h"
+#include "Tools/LinearArena.h"
+#include "Tools/ThreadPool.h"
+
+namespace RioGame
+{
+
+	class ChangeTracker;
+	class EntityManager;
+
+	// Asynchronous path finding, tasks like GO_TO or GO_NEAR queue a request instead of computing
+	// the path right away. Requests are grouped by (start cluster, goal) so that a group of units
+	// standing close to each other shares a single A* search, the groups are solved in parallel
+	// on the thread pool and the paths are written into PathfindingComponent::pathQueue on the next tick
+	// A unit sharing a search walks to the shared path on a short search of its own, if walls are in
+	// the way it gets a search of its own instead
+	class PathRequestQueue
+	{
+	public:
+		// Requests starting in the same clusterSize x clusterSize block of nodes share a search
+		static constexpr uint32_t clusterSize = 4;
+
+		// Bookkeeping of the searches lives in the frame arena, found paths in the arena of the thread that found them
+		// Both have to stay valid from a dispatch until the following deliver
+		PathRequestQueue(EntityManager& entityManager, ChangeTracker& changes, ThreadPool& threadPool
+			, LinearArena& frameArena, ThreadArenas& threadArenas);
+		PathRequestQueue(const PathRequestQueue&) = delete;
+		PathRequestQueue& operator=(const PathRequestQueue&) = delete;
+		// Waits for the searches still running
+		~PathRequestQueue();
+
+		// Queues a path request from start to goal (ids of grid node entities), a newer request
+		// of the same entity overrides the older one, if near is true the path ends next to the goal
+		void request(uint32_t entity, uint32_t start, uint32_t goal, bool near = false);
+		// Queues one search from starts[0] to goal for count entities (a commanded group), every entity
+		// walks from its start onto the path and leaves it on a short search to its end (its place in
+		// the formation), which becomes the last node of its path and its targetId
+		void requestGroup(const uint32_t* entities, const uint32_t* starts, const uint32_t* ends, uint32_t count, uint32_t goal);
+		// Waits for the searches started by the last dispatch and writes their paths to the requesters
+		void deliver();
+		// Starts the searches for all queued requests
+		void dispatch();
+		// The node graph gets rebuilt on the next dispatch, grid nodes that are added, removed or
+		// marked changed (their free state) invalidate it too
+		void invalidateGraph();
+
+		uint32_t getQueuedCount() const;
+	private:
+		// Snapshot of the grid the workers search in, nodes are referenced by dense indices
+		struct Graph
+		{
+			std::vector<uint32_t> ids;
+			std::unordered_map<uint32_t, uint32_t> indices;
+			std::vector<std::array<uint32_t, GridNodeComponent::neighbourCount>> neighbours;
+			std::vector<uint8_t> free;
+			std::vector<uint32_t> x;
+			std::vector<uint32_t> y;
+			bool hasPortals = false;
+		};
+
+		struct Request
+		{
+			uint32_t entity;
+			uint32_t start;
+			uint32_t goal;
+			uint32_t ticket;
+			// Group sharing the search regardless of the start cluster (NO_GROUP for single requests)
+			uint32_t group;
+			// Node the path ends in instead of the goal (NO_NODE if it ends in the goal)
+			uint32_t end;
+			bool near;
+			// Solved on its own, the shared path wasn't reachable from the start
+			bool alone;
+		};
+
+		// How a request's path is put together from the job's path
+		struct Connection
+		{
+			// Range of the nodes in Job::connectors leading from the request's start onto the path
+			uint32_t joinBegin;
+			uint32_t joinEnd;
+			// Range of the nodes in Job::connectors leading from the path to the request's end
+			uint32_t leaveBegin;
+			uint32_t leaveEnd;
+			// Range of the job's path the request follows
+			uint32_t first;
+			uint32_t last;
+			bool reachable;
+		};
+
+		struct Job
+		{
+			uint32_t start;
+			uint32_t goal;
+			bool near;
+			ArenaVector<Request> requests;
+			// Dense node indices from the node after start up to the goal, empty if there's no path
+			// or the path has no steps (the start is the goal)
+			ArenaVector<uint32_t> path;
+			// One per request
+			ArenaVector<Connection> connections;
+			ArenaVector<uint32_t> connectors;
+			bool found = false;
+		};
+
+		// Search data of a thread, allocated once per thread and reused by all of its searches
+		// Stamps avoid clearing the arrays between searches
+		struct Scratch
+		{
+			std::vector<float> cost;
+			std::vector<uint32_t> parent;
+			std::vector<uint32_t> visited;
+			std::vector<uint32_t> closed;
+			std::vector<std::pair<float, uint32_t>> open;
+			uint32_t stamp = 0;
+			// Nodes of the path of the current job and their positions (0 for the start, i + 1 for path[i])
+			std::vector<uint32_t> onPath;
+			std::vector<uint32_t> position;
+			uint32_t pathMark = 0;
+		};
+
+		void rebuildGraph();
+		void solve(Job& job, Scratch& scratch, LinearArena& arena) const;
+		// Searches from the node for the closest node of the current job's path at minPosition or later and
+		// returns its position (NO_NODE if none is found within a few steps)
+		// If toPath is true the nodes walked from the node onto the path are appended to connectors,
+		// otherwise the nodes walked from the path to the node, the node included
+		uint32_t connect(uint32_t from, uint32_t minPosition, bool toPath
+			, Scratch& scratch, ArenaVector<uint32_t>& connectors) const;
+		// Queues the request again, to be solved without sharing the search
+		void requestAlone(const Request& request, uint32_t goal);
+		float heuristic(uint32_t from, uint32_t to) const;
+
+		EntityManager& entityManager;
+		ChangeTracker& changes;
+		ThreadPool& threadPool;
+		LinearArena& frameArena;
+		ThreadArenas& threadArenas;
+
+		Graph graph;
+		bool graphDirty = true;
+		uint32_t nodeChanges;
+
+		std::vector<Request> queued;
+		// Latest ticket of every entity waiting for a path, older results are dropped
+		std::unordered_map<uint32_t, uint32_t> tickets;
+		uint32_t nextTicket = 0;
+		uint32_t nextGroup = 0;
+
+		std::vector<Job> jobs;
+		JobGroup running;
+		std::vector<Scratch> scratches;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,148 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "PrefabLibrary.h"
+
+#include "ComponentRegistry.h"
+#include "Components.h"
+#include "EntityManager.h"
+
+namespace RioGame
+{
+
+	namespace
+	{
+		// Per instance patches, by default the component is copied as is
+		template<typename T>
+		void patch(T&, uint32_t, const Vec2*)
+		{
+		}
+
+		void patch(PhysicsComponent& component, uint32_t index, const Vec2* positions)
+		{
+			if (positions != nullptr)
+			{
+				component.position = positions[index];
+			}
+		}
+
+		void patch(GraphicsComponent& component, uint32_t, const Vec2*)
+		{
+			component.node = nullptr;
+			component.entity = uint32_t(-1);
+		}
+
+		void patch(SelectionComponent& component, uint32_t, const Vec2*)
+		{
+			component.entity = uint32_t(-1);
+		}
+	} // namespace
+
+	template<typename T>
+	struct Prefab::ComponentRow : public Prefab::Row
+	{
+		ComponentRow(const T& component)
+			: component{ component }
+		{
+		}
+
+		void instantiate(EntityManager& entityManager, const uint32_t* ids, uint32_t count, const Vec2* positions) const override
+		{
+			// One rehash for the whole batch instead of several while the entities are added
+			auto& container = entityManager.getComponentContainer<T>();
+			container.reserve(container.size() + count);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				T copy{ this->component };
+				patch(copy, i, positions);
+				entityManager.addComponent<T>(ids[i], copy);
+			}
+		}
+
+		T component;
+	};
+
+	Prefab::~Prefab()
+	{
+	}
+
+	void Prefab::bake(EntityManager& entityManager, uint32_t templateEntity)
+	{
+		this->rows.clear();
+		forEachComponentType([this, &entityManager, templateEntity](auto tag)
+		{
+			bakeComponent<typename decltype(tag)::Type>(entityManager, templateEntity);
+		});
+	}
+
+	void Prefab::instantiate(EntityManager& entityManager, uint32_t count
+		, const Vec2* positions, std::vector<uint32_t>& created) const
+	{
+		size_t first = created.size();
+		created.reserve(first + count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			created.push_back(entityManager.createEntity());
+		}
+
+		for (const auto& row : this->rows)
+		{
+			row->instantiate(entityManager, created.data() + first, count, positions);
+		}
+	}
+
+	uint32_t Prefab::getComponentCount() const
+	{
+		return (uint32_t)this->rows.size();
+	}
+
+	template<typename T>
+	void Prefab::bakeComponent(EntityManager& entityManager, uint32_t templateEntity)
+	{
+		T* component = entityManager.getComponent<T>(templateEntity);
+		if (component != nullptr)
+		{
+			this->rows.emplace_back(new ComponentRow<T>{ *component });
+		}
+	}
+
+	PrefabLibrary::PrefabLibrary(EntityManager& entityManager)
+		: entityManager{ entityManager }
+	{
+	}
+
+	Prefab& PrefabLibrary::bake(const std::string& blueprint, uint32_t templateEntity)
+	{
+		Prefab& prefab = this->prefabs[blueprint];
+		prefab.bake(this->entityManager, templateEntity);
+		return prefab;
+	}
+
+	const Prefab* PrefabLibrary::get(const std::string& blueprint) const
+	{
+		auto it = this->prefabs.find(blueprint);
+		return it != this->prefabs.end() ? &it->second : nullptr;
+	}
+
+	void PrefabLibrary::remove(const std::string& blueprint)
+	{
+		this->prefabs.erase(blueprint);
+	}
+
+	bool PrefabLibrary::instantiate(const std::string& blueprint, uint32_t count
+		, const Vec2* positions, std::vector<uint32_t>& created)
+	{
+		const Prefab* prefab = get(blueprint);
+		if (prefab == nullptr)
+		{
+			return false;
+		}
+		prefab->instantiate(this->entityManager, count, positions, created);
+		return true;
+	}
+
+	void PrefabLibrary::clear()
+	{
+		this->prefabs.clear();
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
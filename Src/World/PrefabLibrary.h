@@ -0,0 +1,81 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "math/Vec2.h"
+
+namespace RioGame
+{
+
+	using ::RioEngine::Vec2;
+
+	class EntityManager;
+
+	// Pre-baked blueprint, holds a default copy of every component of an entity built once by
+	// the EntityCreator, so that spawning doesn't have to run the blueprint again
+	class Prefab
+	{
+	public:
+		Prefab() = default;
+		Prefab(const Prefab&) = delete;
+		Prefab& operator=(const Prefab&) = delete;
+		Prefab(Prefab&&) = default;
+		Prefab& operator=(Prefab&&) = default;
+		~Prefab();
+
+		// Replaces the prefab's components with copies of the components of the given entity
+		void bake(EntityManager& entityManager, uint32_t templateEntity);
+		// Creates count entities, one component type at a time, and appends their ids to created
+		// If positions is not null it has to hold count positions, which are patched into the PhysicsComponents
+		// Per entity handles (GraphicsComponent::node and ::entity, SelectionComponent::entity) are reset,
+		// the systems create them for each instance. Constructor blueprints are not called, that is up to the caller
+		void instantiate(EntityManager& entityManager, uint32_t count
+			, const Vec2* positions, std::vector<uint32_t>& created) const;
+
+		uint32_t getComponentCount() const;
+	private:
+		// Holds one component and copies it to a range of entities
+		struct Row
+		{
+			virtual ~Row() = default;
+			virtual void instantiate(EntityManager& entityManager, const uint32_t* ids, uint32_t count, const Vec2* positions) const = 0;
+		};
+
+		template<typename T>
+		struct ComponentRow;
+
+		template<typename T>
+		void bakeComponent(EntityManager& entityManager, uint32_t templateEntity);
+
+		std::vector<std::unique_ptr<Row>> rows;
+	};
+
+	// Prefabs by blueprint name
+	class PrefabLibrary
+	{
+	public:
+		PrefabLibrary(EntityManager& entityManager);
+		PrefabLibrary(const PrefabLibrary&) = delete;
+		PrefabLibrary& operator=(const PrefabLibrary&) = delete;
+
+		// Bakes (or re-bakes) the prefab of a blueprint from an entity built from it, the entity can be destroyed afterwards
+		Prefab& bake(const std::string& blueprint, uint32_t templateEntity);
+		// Returns the prefab of the blueprint or nullptr if it hasn't been baked
+		const Prefab* get(const std::string& blueprint) const;
+		void remove(const std::string& blueprint);
+		// Spawns count entities of a baked blueprint, returns false if the blueprint has no prefab
+		bool instantiate(const std::string& blueprint, uint32_t count
+			, const Vec2* positions, std::vector<uint32_t>& created);
+		void clear();
+	private:
+		EntityManager& entityManager;
+		std::unordered_map<std::string, Prefab> prefabs;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
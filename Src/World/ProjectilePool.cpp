@@ -0,0 +1,169 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "ProjectilePool.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/Macros.h" // for RioAssert
+#include "2d/CCNode.h"
+
+#include "Components.h"
+
+namespace RioGame
+{
+
+	ProjectilePool::ProjectilePool(uint32_t capacity)
+		: capacity{ capacity }
+		, positionX(capacity)
+		, positionY(capacity)
+		, targetX(capacity)
+		, targetY(capacity)
+		, speed(capacity)
+		, source(capacity)
+		, target(capacity)
+		, dmg(capacity)
+		, nodes(capacity, nullptr)
+		, hit(capacity)
+	{
+	}
+
+	bool ProjectilePool::spawn(const Vec2& position, const Vec2& targetPosition
+		, uint32_t sourceId, uint32_t targetId, uint32_t damage, float projectileSpeed)
+	{
+		if (this->activeCount >= this->capacity)
+		{
+			return false;
+		}
+
+		uint32_t index = this->activeCount++;
+		this->positionX[index] = position.x;
+		this->positionY[index] = position.y;
+		this->targetX[index] = targetPosition.x;
+		this->targetY[index] = targetPosition.y;
+		this->speed[index] = projectileSpeed;
+		this->source[index] = sourceId;
+		this->target[index] = targetId;
+		this->dmg[index] = damage;
+		return true;
+	}
+
+	void ProjectilePool::step(float delta, float hitRadius, std::vector<Impact>& impacts)
+	{
+		const uint32_t count = this->activeCount;
+		float* px = this->positionX.data();
+		float* py = this->positionY.data();
+		const float* tx = this->targetX.data();
+		const float* ty = this->targetY.data();
+		const float* sp = this->speed.data();
+		uint8_t* hits = this->hit.data();
+
+		// Homing and impact test, no branches or calls so that the compiler can vectorize it
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			float dx = tx[i] - px[i];
+			float dy = ty[i] - py[i];
+			float distanceSquared = dx * dx + dy * dy;
+			float stepLength = sp[i] * delta;
+			float reach = stepLength + hitRadius;
+			float t = std::min(stepLength / std::sqrt(std::max(distanceSquared, 1e-6f)), 1.0f);
+			px[i] += dx * t;
+			py[i] += dy * t;
+			hits[i] = (uint8_t)(distanceSquared <= reach * reach);
+		}
+
+		// Backwards so that the swapped in projectile has already been tested
+		for (uint32_t i = count; i-- > 0;)
+		{
+			if (hits[i])
+			{
+				if (this->target[i] != Component::NO_ENTITY)
+				{
+					impacts.push_back(Impact{ this->source[i], this->target[i], this->dmg[i] });
+				}
+				release(i);
+			}
+		}
+	}
+
+	void ProjectilePool::clear()
+	{
+		while (this->activeCount > 0)
+		{
+			release(this->activeCount - 1);
+		}
+	}
+
+	uint32_t ProjectilePool::getCapacity() const
+	{
+		return this->capacity;
+	}
+
+	uint32_t ProjectilePool::getActiveCount() const
+	{
+		return this->activeCount;
+	}
+
+	uint32_t ProjectilePool::getTarget(uint32_t index) const
+	{
+		RioAssert(index < this->activeCount, "Projectile index out of range");
+		return this->target[index];
+	}
+
+	void ProjectilePool::loseTarget(uint32_t index)
+	{
+		RioAssert(index < this->activeCount, "Projectile index out of range");
+		this->target[index] = Component::NO_ENTITY;
+	}
+
+	void ProjectilePool::setTargetPosition(uint32_t index, const Vec2& targetPosition)
+	{
+		RioAssert(index < this->activeCount, "Projectile index out of range");
+		this->targetX[index] = targetPosition.x;
+		this->targetY[index] = targetPosition.y;
+	}
+
+	Vec2 ProjectilePool::getPosition(uint32_t index) const
+	{
+		RioAssert(index < this->activeCount, "Projectile index out of range");
+		return Vec2{ this->positionX[index], this->positionY[index] };
+	}
+
+	Node* ProjectilePool::getNode(uint32_t index) const
+	{
+		RioAssert(index < this->capacity, "Projectile index out of range");
+		return this->nodes[index];
+	}
+
+	void ProjectilePool::setNode(uint32_t index, Node* node)
+	{
+		RioAssert(index < this->capacity, "Projectile index out of range");
+		this->nodes[index] = node;
+	}
+
+	void ProjectilePool::release(uint32_t index)
+	{
+		uint32_t last = --this->activeCount;
+
+		if (this->nodes[index] != nullptr)
+		{
+			this->nodes[index]->setVisible(false);
+		}
+
+		if (index != last)
+		{
+			this->positionX[index] = this->positionX[last];
+			this->positionY[index] = this->positionY[last];
+			this->targetX[index] = this->targetX[last];
+			this->targetY[index] = this->targetY[last];
+			this->speed[index] = this->speed[last];
+			this->source[index] = this->source[last];
+			this->target[index] = this->target[last];
+			this->dmg[index] = this->dmg[last];
+			this->hit[index] = this->hit[last];
+			// The released node is parked behind the active range to be reused by the next spawn
+			std::swap(this->nodes[index], this->nodes[last]);
+		}
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,80 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "math/Vec2.h"
+
+namespace RioEngine
+{
+	class Node;
+}
+
+namespace RioGame
+{
+
+	using ::RioEngine::Vec2;
+	using ::RioEngine::Node;
+
+	// Fixed capacity storage for homing projectiles kept as a structure of arrays
+	// Active projectiles are always packed at the front ([0, activeCount)), a released slot
+	// is filled by the last active one, so the homing and impact passes run over dense arrays
+	// Scene nodes stay with their slot data and are only hidden when a projectile is released, never destroyed
+	class ProjectilePool
+	{
+	public:
+		struct Impact
+		{
+			uint32_t source;
+			uint32_t target;
+			uint32_t dmg;
+		};
+
+		explicit ProjectilePool(uint32_t capacity = 4096);
+		ProjectilePool(const ProjectilePool&) = delete;
+		ProjectilePool& operator=(const ProjectilePool&) = delete;
+
+		// Activates a slot for a new projectile, returns false if the pool is exhausted
+		bool spawn(const Vec2& position, const Vec2& targetPosition
+			, uint32_t source, uint32_t target, uint32_t dmg, float speed);
+		// Moves all projectiles towards their targets, appends the projectiles that reached
+		// their target this step to impacts and releases their slots
+		void step(float delta, float hitRadius, std::vector<Impact>& impacts);
+		// Releases all projectiles (used when a level is cleared)
+		void clear();
+
+		uint32_t getCapacity() const;
+		uint32_t getActiveCount() const;
+
+		// Dense accessors, valid for indices in [0, getActiveCount())
+		uint32_t getTarget(uint32_t index) const;
+		// Marks the target as lost, the projectile then lands on the last known position without dealing damage
+		void loseTarget(uint32_t index);
+		void setTargetPosition(uint32_t index, const Vec2& targetPosition);
+		Vec2 getPosition(uint32_t index) const;
+		// Scene node of a slot, indexes up to getCapacity() so that nodes of released slots can be reused
+		Node* getNode(uint32_t index) const;
+		void setNode(uint32_t index, Node* node);
+	private:
+		// Moves the data of the last active projectile into the given slot
+		void release(uint32_t index);
+
+		uint32_t capacity = 0;
+		uint32_t activeCount = 0;
+
+		std::vector<float> positionX;
+		std::vector<float> positionY;
+		std::vector<float> targetX;
+		std::vector<float> targetY;
+		std::vector<float> speed;
+		std::vector<uint32_t> source;
+		std::vector<uint32_t> target;
+		std::vector<uint32_t> dmg;
+		std::vector<Node*> nodes;
+		// Hit flags written by the homing pass, kept separate so that the pass stays branch free
+		std::vector<uint8_t> hit;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
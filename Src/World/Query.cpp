@@ -0,0 +1,164 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "Query.h"
+
+#include "ComponentRegistry.h"
+
+namespace RioGame
+{
+
+	uint32_t QueryCache::getView(const ComponentSignature& with, const ComponentSignature& without)
+	{
+		// Systems use a handful of views, a linear search beats hashing the signatures
+		for (uint32_t i = 0; i < this->views.size(); ++i)
+		{
+			if (this->views[i].with == with && this->views[i].without == without)
+			{
+				return i;
+			}
+		}
+
+		this->views.emplace_back();
+		View& view = this->views.back();
+		view.with = with;
+		view.without = without;
+		for (const auto& entity : this->signatures)
+		{
+			if (view.matches(entity.second))
+			{
+				view.add(entity.first);
+			}
+		}
+		return (uint32_t)this->views.size() - 1;
+	}
+
+	const std::vector<uint32_t>& QueryCache::getEntities(uint32_t view) const
+	{
+		return this->views[view].entities;
+	}
+
+	void QueryCache::componentAdded(uint32_t entity, uint32_t type)
+	{
+		ComponentSignature& signature = this->signatures[entity];
+		ComponentSignature before = signature;
+		signature.set(type);
+		update(entity, before, signature);
+	}
+
+	void QueryCache::componentRemoved(uint32_t entity, uint32_t type)
+	{
+		auto it = this->signatures.find(entity);
+		if (it == this->signatures.end())
+		{
+			return;
+		}
+
+		ComponentSignature before = it->second;
+		it->second.reset(type);
+		update(entity, before, it->second);
+		if (it->second.none())
+		{
+			this->signatures.erase(it);
+		}
+	}
+
+	void QueryCache::entityDestroyed(uint32_t entity)
+	{
+		auto it = this->signatures.find(entity);
+		if (it == this->signatures.end())
+		{
+			return;
+		}
+
+		update(entity, it->second, ComponentSignature{});
+		this->signatures.erase(it);
+	}
+
+	void QueryCache::refresh(uint32_t entity, EntityManager& entityManager)
+	{
+		ComponentSignature signature;
+		forEachComponentType([&signature, &entityManager, entity](auto tag)
+		{
+			using Type = typename decltype(tag)::Type;
+			signature.set(ComponentTraits<Type>::id, entityManager.template hasComponent<Type>(entity));
+		});
+
+		auto it = this->signatures.find(entity);
+		ComponentSignature before = it != this->signatures.end() ? it->second : ComponentSignature{};
+		update(entity, before, signature);
+		if (signature.none())
+		{
+			if (it != this->signatures.end())
+			{
+				this->signatures.erase(it);
+			}
+		}
+		else
+		{
+			this->signatures[entity] = signature;
+		}
+	}
+
+	ComponentSignature QueryCache::getSignature(uint32_t entity) const
+	{
+		auto it = this->signatures.find(entity);
+		return it != this->signatures.end() ? it->second : ComponentSignature{};
+	}
+
+	void QueryCache::clear()
+	{
+		this->signatures.clear();
+		for (auto& view : this->views)
+		{
+			view.entities.clear();
+			view.indices.clear();
+		}
+	}
+
+	uint32_t QueryCache::getViewCount() const
+	{
+		return (uint32_t)this->views.size();
+	}
+
+	bool QueryCache::View::matches(const ComponentSignature& signature) const
+	{
+		return (signature & this->with) == this->with && (signature & this->without).none();
+	}
+
+	void QueryCache::View::add(uint32_t entity)
+	{
+		this->indices.emplace(entity, (uint32_t)this->entities.size());
+		this->entities.push_back(entity);
+	}
+
+	void QueryCache::View::remove(uint32_t entity)
+	{
+		auto it = this->indices.find(entity);
+		uint32_t index = it->second;
+		this->indices.erase(it);
+		if (index != this->entities.size() - 1)
+		{
+			this->entities[index] = this->entities.back();
+			this->indices[this->entities[index]] = index;
+		}
+		this->entities.pop_back();
+	}
+
+	void QueryCache::update(uint32_t entity, const ComponentSignature& before, const ComponentSignature& after)
+	{
+		for (auto& view : this->views)
+		{
+			bool matched = view.matches(before);
+			bool matches = view.matches(after);
+			if (matched && !matches)
+			{
+				view.remove(entity);
+			}
+			else if (!matched && matches)
+			{
+				view.add(entity);
+			}
+		}
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,179 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/Macros.h" // for RioAssert
+
+#include "Components.h"
+#include "EntityManager.h"
+#include "Tools/ThreadPool.h"
+
+namespace RioGame
+{
+
+	using ComponentSignature = std::bitset<Component::count>;
+
+	template<typename... Ts>
+	struct SignatureOf;
+
+	template<>
+	struct SignatureOf<>
+	{
+		static ComponentSignature get()
+		{
+			return ComponentSignature{};
+		}
+	};
+
+	template<typename T, typename... Ts>
+	struct SignatureOf<T, Ts...>
+	{
+		static ComponentSignature get()
+		{
+			return SignatureOf<Ts...>::get().set(T::type);
+		}
+	};
+
+	// Component sets of all entities and the cached entity lists of every view (components an entity
+	// has to have and components it must not have) that was queried so far
+	// Views are created and filled on first use, afterwards they are only updated when an entity
+	// gains or loses a component, so a query never scans the entities
+	// Component changes are reported by the World's addComponent/deleteComponent/destroyEntity/discardEntity/scheduleToRemove,
+	// entities built directly through the EntityManager are added with World::registerEntity
+	class QueryCache
+	{
+	public:
+		QueryCache() = default;
+		QueryCache(const QueryCache&) = delete;
+		QueryCache& operator=(const QueryCache&) = delete;
+
+		// Returns the id of the view, creating it if it doesn't exist yet
+		uint32_t getView(const ComponentSignature& with, const ComponentSignature& without);
+		// Entities of the view in no particular order
+		const std::vector<uint32_t>& getEntities(uint32_t view) const;
+
+		void componentAdded(uint32_t entity, uint32_t type);
+		void componentRemoved(uint32_t entity, uint32_t type);
+		void entityDestroyed(uint32_t entity);
+		// Reads the component set of the entity from the manager (one lookup per component type)
+		void refresh(uint32_t entity, EntityManager& entityManager);
+		// Components the entity has as far as the cache knows
+		ComponentSignature getSignature(uint32_t entity) const;
+		void clear();
+
+		uint32_t getViewCount() const;
+	private:
+		struct View
+		{
+			ComponentSignature with;
+			ComponentSignature without;
+			std::vector<uint32_t> entities;
+			std::unordered_map<uint32_t, uint32_t> indices;
+
+			bool matches(const ComponentSignature& signature) const;
+			void add(uint32_t entity);
+			void remove(uint32_t entity);
+		};
+
+		void update(uint32_t entity, const ComponentSignature& before, const ComponentSignature& after);
+
+		std::unordered_map<uint32_t, ComponentSignature> signatures;
+		std::vector<View> views;
+	};
+
+	// Entities having all components Ts (and none of the excluded ones), obtained with World::query<Ts...>()
+	//
+	// world.query<PhysicsComponent, MovementComponent>().without<StructureComponent>()
+	//     .forEach([](uint32_t entity, PhysicsComponent& physics, MovementComponent& movement) { ... });
+	template<typename... Ts>
+	class Query
+	{
+	public:
+		Query(QueryCache& cache, EntityManager& entityManager, ThreadPool& threadPool
+			, const ComponentSignature& excluded = ComponentSignature{})
+			: cache{ cache }
+			, entityManager{ entityManager }
+			, threadPool{ threadPool }
+			, excluded{ excluded }
+		{
+		}
+
+		template<typename... Excluded>
+		Query without() const
+		{
+			return Query{ this->cache, this->entityManager, this->threadPool, this->excluded | SignatureOf<Excluded...>::get() };
+		}
+
+		const std::vector<uint32_t>& getEntities() const
+		{
+			return this->cache.getEntities(getView());
+		}
+
+		uint32_t size() const
+		{
+			return (uint32_t)getEntities().size();
+		}
+
+		// Calls function(entity, Ts&...) for every entity, the function may add and remove components
+		// of the entity it was called for (entities that start matching during the iteration are skipped)
+		template<typename Function>
+		void forEach(Function&& function) const
+		{
+			const auto& entities = getEntities();
+			// Backwards, so that an entity removed from the view only moves an already visited entity
+			for (uint32_t i = (uint32_t)entities.size(); i-- > 0;)
+			{
+				if (i < entities.size())
+				{
+					call(function, entities[i]);
+				}
+			}
+		}
+
+		// Calls function(entity, Ts&...) for the entities in parallel, grain entities per job
+		// The function must not add or remove components or create and destroy entities
+		template<typename Function>
+		void parallelForEach(Function&& function, uint32_t grain = 256) const
+		{
+			const auto& entities = getEntities();
+			this->threadPool.parallelFor((uint32_t)entities.size(), grain, [this, &entities, &function](uint32_t begin, uint32_t end, uint32_t)
+			{
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					call(function, entities[i]);
+				}
+			});
+		}
+	private:
+		uint32_t getView() const
+		{
+			return this->cache.getView(SignatureOf<Ts...>::get(), this->excluded);
+		}
+
+		template<typename Function>
+		void call(Function& function, uint32_t entity) const
+		{
+			function(entity, getComponent<Ts>(entity)...);
+		}
+
+		template<typename T>
+		T& getComponent(uint32_t entity) const
+		{
+			T* component = this->entityManager.template getComponent<T>(entity);
+			RioAssert(component != nullptr, "Query cache out of sync with the EntityManager");
+			return *component;
+		}
+
+		QueryCache& cache;
+		EntityManager& entityManager;
+		ThreadPool& threadPool;
+		ComponentSignature excluded;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
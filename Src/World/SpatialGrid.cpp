@@ -0,0 +1,120 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "SpatialGrid.h"
+
+namespace RioGame
+{
+
+	SpatialGrid::SpatialGrid(float cellSize)
+		: inverseCellSize{ 1.0f / cellSize }
+	{
+	}
+
+	void SpatialGrid::insert(uint32_t entity, const Vec2& position)
+	{
+		uint64_t key = getKey(getCoordinate(position.x), getCoordinate(position.y));
+		auto location = this->locations.find(entity);
+		if (location != this->locations.end())
+		{
+			if (location->second.cell == key)
+			{
+				this->cells[key][location->second.slot].position = position;
+				return;
+			}
+			remove(entity);
+		}
+
+		auto& cell = this->cells[key];
+		this->locations[entity] = Location{ key, (uint32_t)cell.size() };
+		cell.push_back(Item{ entity, position });
+	}
+
+	void SpatialGrid::remove(uint32_t entity)
+	{
+		auto location = this->locations.find(entity);
+		if (location == this->locations.end())
+		{
+			return;
+		}
+
+		auto cell = this->cells.find(location->second.cell);
+		auto& items = cell->second;
+		uint32_t slot = location->second.slot;
+		if (slot != items.size() - 1)
+		{
+			items[slot] = items.back();
+			this->locations[items[slot].entity].slot = slot;
+		}
+		items.pop_back();
+		if (items.empty())
+		{
+			this->cells.erase(cell);
+		}
+		this->locations.erase(entity);
+	}
+
+	bool SpatialGrid::contains(uint32_t entity) const
+	{
+		return this->locations.count(entity) > 0;
+	}
+
+	void SpatialGrid::clear()
+	{
+		this->cells.clear();
+		this->locations.clear();
+	}
+
+	uint32_t SpatialGrid::size() const
+	{
+		return (uint32_t)this->locations.size();
+	}
+
+	void SpatialGrid::query(const Vec2& min, const Vec2& max, std::vector<uint32_t>& result) const
+	{
+		int32_t minX = getCoordinate(min.x);
+		int32_t maxX = getCoordinate(max.x);
+		int32_t minY = getCoordinate(min.y);
+		int32_t maxY = getCoordinate(max.y);
+
+		// Big rectangles over a sparse grid are cheaper to answer by walking the occupied cells
+		bool walkCells = (uint64_t)(maxX - minX + 1) * (uint64_t)(maxY - minY + 1) > this->cells.size();
+		auto collect = [&min, &max, &result](const std::vector<Item>& items)
+		{
+			for (const auto& item : items)
+			{
+				if (item.position.x >= min.x && item.position.y >= min.y
+					&& item.position.x <= max.x && item.position.y <= max.y)
+				{
+					result.push_back(item.entity);
+				}
+			}
+		};
+
+		if (walkCells)
+		{
+			for (const auto& cell : this->cells)
+			{
+				int32_t x = (int32_t)(uint32_t)(cell.first >> 32);
+				int32_t y = (int32_t)(uint32_t)cell.first;
+				if (x >= minX && x <= maxX && y >= minY && y <= maxY)
+				{
+					collect(cell.second);
+				}
+			}
+			return;
+		}
+
+		for (int32_t y = minY; y <= maxY; ++y)
+		{
+			for (int32_t x = minX; x <= maxX; ++x)
+			{
+				auto cell = this->cells.find(getKey(x, y));
+				if (cell != this->cells.end())
+				{
+					collect(cell->second);
+				}
+			}
+		}
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
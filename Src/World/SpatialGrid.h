@@ -0,0 +1,92 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "math/Vec2.h"
+
+namespace RioGame
+{
+
+	using ::RioEngine::Vec2;
+
+	// Uniform grid of entity positions for range queries, only non-empty cells are stored
+	class SpatialGrid
+	{
+	public:
+		SpatialGrid(float cellSize = 4.0f);
+
+		// Inserts the entity or moves it if it's already in the grid
+		void insert(uint32_t entity, const Vec2& position);
+		void remove(uint32_t entity);
+		bool contains(uint32_t entity) const;
+		void clear();
+		uint32_t size() const;
+
+		// Appends the entities inside the rectangle (borders included) to result
+		void query(const Vec2& min, const Vec2& max, std::vector<uint32_t>& result) const;
+
+		// Calls function(entity, position) for the entities within radius of the center
+		template<typename Function>
+		void forEachInRadius(const Vec2& center, float radius, Function&& function) const
+		{
+			int32_t minX = getCoordinate(center.x - radius);
+			int32_t maxX = getCoordinate(center.x + radius);
+			int32_t minY = getCoordinate(center.y - radius);
+			int32_t maxY = getCoordinate(center.y + radius);
+			float radiusSquared = radius * radius;
+
+			for (int32_t y = minY; y <= maxY; ++y)
+			{
+				for (int32_t x = minX; x <= maxX; ++x)
+				{
+					auto cell = this->cells.find(getKey(x, y));
+					if (cell == this->cells.end())
+					{
+						continue;
+					}
+					for (const auto& item : cell->second)
+					{
+						float dx = item.position.x - center.x;
+						float dy = item.position.y - center.y;
+						if (dx * dx + dy * dy <= radiusSquared)
+						{
+							function(item.entity, item.position);
+						}
+					}
+				}
+			}
+		}
+	private:
+		struct Item
+		{
+			uint32_t entity;
+			Vec2 position;
+		};
+
+		struct Location
+		{
+			uint64_t cell;
+			uint32_t slot;
+		};
+
+		int32_t getCoordinate(float value) const
+		{
+			return (int32_t)std::floor(value * this->inverseCellSize);
+		}
+
+		static uint64_t getKey(int32_t x, int32_t y)
+		{
+			return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+		}
+
+		float inverseCellSize;
+		std::unordered_map<uint64_t, std::vector<Item>> cells;
+		std::unordered_map<uint32_t, Location> locations;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
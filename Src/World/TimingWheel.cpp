@@ -0,0 +1,309 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "TimingWheel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/Macros.h" // for RioAssert
+
+namespace RioGame
+{
+
+	TimingWheel::TimingWheel(float tickLength)
+		: tickLength{ tickLength }
+	{
+		for (auto& level : this->wheel)
+		{
+			level.fill(NO_TIMER);
+		}
+	}
+
+	void TimingWheel::setHandler(TimerType type, Handler handler)
+	{
+		this->handlers[(uint32_t)type] = std::move(handler);
+	}
+
+	uint32_t TimingWheel::schedule(TimerType type, uint32_t entity, float seconds, float period)
+	{
+		uint32_t index = allocate();
+		Timer& timer = this->timers[index];
+		timer.type = type;
+		timer.entity = entity;
+		timer.period = period > 0.0f ? toTicks(period) : 0;
+		timer.deadline = this->currentTick + toTicks(seconds);
+		timer.pending = true;
+		insert(index);
+		++this->pendingCount;
+		return makeHandle(index);
+	}
+
+	void TimingWheel::cancel(uint32_t handle)
+	{
+		uint32_t index = resolve(handle);
+		if (index != NO_TIMER)
+		{
+			unlink(index);
+			release(index);
+		}
+	}
+
+	bool TimingWheel::isPending(uint32_t handle) const
+	{
+		return resolve(handle) != NO_TIMER;
+	}
+
+	float TimingWheel::getRemainingTime(uint32_t handle) const
+	{
+		uint32_t index = resolve(handle);
+		if (index == NO_TIMER)
+		{
+			return 0.0f;
+		}
+
+		float remaining = (this->timers[index].deadline - this->currentTick) * this->tickLength - this->accumulator;
+		return std::max(remaining, 0.0f);
+	}
+
+	void TimingWheel::advance(float delta)
+	{
+		this->accumulator += delta;
+		while (this->accumulator >= this->tickLength)
+		{
+			this->accumulator -= this->tickLength;
+			tick();
+		}
+	}
+
+	void TimingWheel::clear()
+	{
+		for (uint32_t i = 0; i < this->timers.size(); ++i)
+		{
+			if (this->timers[i].pending)
+			{
+				this->timers[i].bucket = noBucket;
+				release(i);
+			}
+		}
+
+		for (auto& level : this->wheel)
+		{
+			level.fill(NO_TIMER);
+		}
+		this->expired.clear();
+	}
+
+	uint32_t TimingWheel::getPendingCount() const
+	{
+		return this->pendingCount;
+	}
+
+	uint32_t TimingWheel::toTicks(float seconds) const
+	{
+		// Always at least one tick, a timer never fires in the tick it was scheduled in
+		// NaN fails the comparison and fires in the next tick, huge deadlines are clamped to what fits
+		const float maxTicks = float(1u << 31);
+		float ticks = std::ceil(seconds / this->tickLength);
+		if (!(ticks >= 1.0f))
+		{
+			return 1;
+		}
+		return ticks < maxTicks ? (uint32_t)ticks : (uint32_t)maxTicks;
+	}
+
+	uint32_t TimingWheel::makeHandle(uint32_t index) const
+	{
+		return ((uint32_t)this->timers[index].generation << indexBits) | index;
+	}
+
+	uint32_t TimingWheel::resolve(uint32_t handle) const
+	{
+		if (handle == NO_TIMER)
+		{
+			return NO_TIMER;
+		}
+
+		uint32_t index = handle & ((1u << indexBits) - 1);
+		if (index >= this->timers.size())
+		{
+			return NO_TIMER;
+		}
+
+		const Timer& timer = this->timers[index];
+		if (!timer.pending || makeHandle(index) != handle)
+		{
+			return NO_TIMER;
+		}
+		return index;
+	}
+
+	uint32_t TimingWheel::allocate()
+	{
+		if (!this->freeTimers.empty())
+		{
+			uint32_t index = this->freeTimers.back();
+			this->freeTimers.pop_back();
+			return index;
+		}
+
+		RioAssert(this->timers.size() < (1u << indexBits) - 1, "Too many timers");
+		this->timers.emplace_back();
+		return (uint32_t)this->timers.size() - 1;
+	}
+
+	void TimingWheel::release(uint32_t index)
+	{
+		Timer& timer = this->timers[index];
+		timer.pending = false;
+		// Generations wrap inside the bits left over by the index
+		timer.generation = (timer.generation + 1) & ((1u << (32 - indexBits)) - 1);
+		--this->pendingCount;
+		this->freeTimers.push_back(index);
+	}
+
+	void TimingWheel::insert(uint32_t index)
+	{
+		Timer& timer = this->timers[index];
+		// Only cascading timers can be due in the current tick, they land in the slot that is about to fire
+		if (timer.deadline < this->currentTick)
+		{
+			timer.deadline = this->currentTick;
+		}
+
+		uint64_t ticksLeft = timer.deadline - this->currentTick;
+		uint32_t level = 0;
+		while (level < levelCount - 1 && ticksLeft >= (1ull << (slotBits * (level + 1))))
+		{
+			++level;
+		}
+
+		// Timers beyond the range of the wheel wait in the last level and get cascaded again
+		uint64_t maxTicks = (1ull << (slotBits * levelCount)) - 1;
+		uint64_t deadline = std::min(timer.deadline, this->currentTick + maxTicks);
+		uint32_t slot = (uint32_t)(deadline >> (slotBits * level)) & (slotCount - 1);
+
+		uint32_t& head = this->wheel[level][slot];
+		timer.bucket = (uint16_t)(level * slotCount + slot);
+		timer.prev = NO_TIMER;
+		timer.next = head;
+		if (head != NO_TIMER)
+		{
+			this->timers[head].prev = index;
+		}
+		head = index;
+	}
+
+	void TimingWheel::unlink(uint32_t index)
+	{
+		Timer& timer = this->timers[index];
+		if (timer.bucket == noBucket)
+		{
+			// Already detached for firing
+			return;
+		}
+
+		if (timer.prev != NO_TIMER)
+		{
+			this->timers[timer.prev].next = timer.next;
+		}
+		else
+		{
+			this->wheel[timer.bucket / slotCount][timer.bucket % slotCount] = timer.next;
+		}
+
+		if (timer.next != NO_TIMER)
+		{
+			this->timers[timer.next].prev = timer.prev;
+		}
+
+		timer.prev = NO_TIMER;
+		timer.next = NO_TIMER;
+		timer.bucket = noBucket;
+	}
+
+	void TimingWheel::cascade(uint32_t level)
+	{
+		uint32_t slot = (uint32_t)(this->currentTick >> (slotBits * level)) & (slotCount - 1);
+		uint32_t index = this->wheel[level][slot];
+		this->wheel[level][slot] = NO_TIMER;
+
+		while (index != NO_TIMER)
+		{
+			uint32_t next = this->timers[index].next;
+			insert(index);
+			index = next;
+		}
+	}
+
+	void TimingWheel::tick()
+	{
+		++this->currentTick;
+
+		// Every time a level wraps around, the next slot of the level above gets distributed
+		for (uint32_t level = 1; level < levelCount; ++level)
+		{
+			if ((this->currentTick & ((1ull << (slotBits * level)) - 1)) != 0)
+			{
+				break;
+			}
+			cascade(level);
+		}
+
+		uint32_t slot = (uint32_t)this->currentTick & (slotCount - 1);
+		uint32_t index = this->wheel[0][slot];
+		this->wheel[0][slot] = NO_TIMER;
+
+		this->expired.clear();
+		while (index != NO_TIMER)
+		{
+			Timer& timer = this->timers[index];
+			uint32_t next = timer.next;
+			timer.prev = NO_TIMER;
+			timer.next = NO_TIMER;
+			timer.bucket = noBucket;
+
+			if (timer.deadline > this->currentTick)
+			{
+				// Clamped timer from the last level, not due yet
+				insert(index);
+			}
+			else
+			{
+				this->expired.push_back(index);
+			}
+			index = next;
+		}
+
+		for (uint32_t i = 0; i < this->expired.size(); ++i)
+		{
+			index = this->expired[i];
+			// Might have been cancelled by a handler called earlier in this tick
+			if (!this->timers[index].pending || this->timers[index].bucket != noBucket)
+			{
+				continue;
+			}
+
+			TimerType type = this->timers[index].type;
+			uint32_t entity = this->timers[index].entity;
+			uint32_t period = this->timers[index].period;
+
+			if (period > 0)
+			{
+				this->timers[index].deadline = this->currentTick + period;
+				insert(index);
+			}
+			else
+			{
+				release(index);
+			}
+
+			// The handler might schedule new timers, so no references are held during the call
+			const Handler& handler = this->handlers[(uint32_t)type];
+			if (handler)
+			{
+				handler(entity);
+			}
+		}
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,96 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "Enums.h"
+
+namespace RioGame
+{
+
+	// Hierarchical timing wheel, entities register a deadline once and the handler of the
+	// timer's type is called when it expires, instead of accumulating the elapsed time every frame
+	// Time is quantized to ticks, level 0 holds timers due in the next 64 ticks, every following
+	// level covers 64 times the range of the previous one, timers cascade down as the wheel turns
+	class TimingWheel
+	{
+	public:
+		using Handler = std::function<void(uint32_t entity)>;
+
+		static constexpr uint32_t NO_TIMER = uint32_t(-1);
+		static constexpr uint32_t slotBits = 6;
+		static constexpr uint32_t slotCount = 1 << slotBits;
+		static constexpr uint32_t levelCount = 4;
+
+		explicit TimingWheel(float tickLength = 1.0f / 60.0f);
+		TimingWheel(const TimingWheel&) = delete;
+		TimingWheel& operator=(const TimingWheel&) = delete;
+
+		// Sets the function called when a timer of the given type expires
+		void setHandler(TimerType type, Handler handler);
+		// Registers a timer that expires after the given amount of seconds, if period is
+		// greater than zero the timer is rescheduled after every expiration (keeping its handle)
+		// Returns the timer's handle
+		uint32_t schedule(TimerType type, uint32_t entity, float seconds, float period = 0.0f);
+		// Removes a pending timer, stale or NO_TIMER handles are ignored
+		void cancel(uint32_t handle);
+		// Returns true if the handle references a pending timer
+		bool isPending(uint32_t handle) const;
+		// Returns the amount of seconds until the timer expires (0 for stale handles)
+		float getRemainingTime(uint32_t handle) const;
+		// Moves the wheel forward by delta seconds, firing all timers that expire on the way
+		void advance(float delta);
+		// Removes all timers
+		void clear();
+
+		uint32_t getPendingCount() const;
+	private:
+		static constexpr uint16_t noBucket = uint16_t(-1);
+		static constexpr uint32_t indexBits = 20;
+
+		struct Timer
+		{
+			uint64_t deadline = 0;
+			uint32_t period = 0;
+			uint32_t entity = 0;
+			// Intrusive slot list links, index into timers
+			uint32_t prev = NO_TIMER;
+			uint32_t next = NO_TIMER;
+			// level * slotCount + slot of the list the timer is linked in, noBucket when detached
+			uint16_t bucket = noBucket;
+			uint16_t generation = 0;
+			TimerType type = TimerType::TIME_EVENT;
+			bool pending = false;
+		};
+
+		uint32_t toTicks(float seconds) const;
+		uint32_t makeHandle(uint32_t index) const;
+		// Returns the index of the timer referenced by the handle or NO_TIMER if it's stale
+		uint32_t resolve(uint32_t handle) const;
+		uint32_t allocate();
+		void release(uint32_t index);
+		void insert(uint32_t index);
+		void unlink(uint32_t index);
+		// Moves all timers of a higher level slot into the lower levels
+		void cascade(uint32_t level);
+		void tick();
+
+		float tickLength;
+		float accumulator = 0.0f;
+		uint64_t currentTick = 0;
+		uint32_t pendingCount = 0;
+
+		std::vector<Timer> timers;
+		std::vector<uint32_t> freeTimers;
+		// Heads of the slot lists
+		std::array<std::array<uint32_t, slotCount>, levelCount> wheel;
+		std::array<Handler, (uint32_t)TimerType::COUNT> handlers;
+		// Timers firing in the current tick, reused between ticks
+		std::vector<uint32_t> expired;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
@@ -0,0 +1,94 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#include "VisibilityIndex.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "Components.h"
+#include "EntityManager.h"
+#include "ChangeTracker.h"
+
+namespace RioGame
+{
+
+	VisibilityIndex::VisibilityIndex(EntityManager& entityManager, ChangeTracker& changes, float cellSize)
+		: entityManager{ entityManager }
+		, changes{ changes }
+		, subscription{ changes.subscribe(PhysicsComponent::type, (uint8_t)ChangeKind::ALL) }
+		, grid{ cellSize }
+	{
+	}
+
+	VisibilityIndex::~VisibilityIndex()
+	{
+		this->changes.unsubscribe(this->subscription);
+	}
+
+	void VisibilityIndex::setView(const Vec2& min, const Vec2& max, float margin)
+	{
+		this->viewMin = Vec2{ min.x - margin, min.y - margin };
+		this->viewMax = Vec2{ max.x + margin, max.y + margin };
+		this->viewSet = true;
+	}
+
+	void VisibilityIndex::clearView()
+	{
+		this->viewSet = false;
+	}
+
+	void VisibilityIndex::process()
+	{
+		this->changes.forEachChange(this->subscription, [this](uint32_t entity, ChangeKind kind)
+		{
+			auto physics = kind != ChangeKind::REMOVED ? this->entityManager.getComponent<PhysicsComponent>(entity) : nullptr;
+			if (physics != nullptr)
+			{
+				this->grid.insert(entity, physics->position);
+			}
+			else
+			{
+				this->grid.remove(entity);
+			}
+		});
+
+		this->previous.swap(this->visible);
+		this->visible.clear();
+		this->entered.clear();
+		if (!this->viewSet)
+		{
+			return;
+		}
+
+		this->grid.query(this->viewMin, this->viewMax, this->visible);
+		std::sort(this->visible.begin(), this->visible.end());
+		std::set_difference(this->visible.begin(), this->visible.end()
+			, this->previous.begin(), this->previous.end(), std::back_inserter(this->entered));
+	}
+
+	bool VisibilityIndex::hasView() const
+	{
+		return this->viewSet;
+	}
+
+	bool VisibilityIndex::isVisible(uint32_t entity) const
+	{
+		return !this->viewSet || std::binary_search(this->visible.begin(), this->visible.end(), entity);
+	}
+
+	const std::vector<uint32_t>& VisibilityIndex::getVisible() const
+	{
+		return this->visible;
+	}
+
+	const std::vector<uint32_t>& VisibilityIndex::getEntered() const
+	{
+		return this->entered;
+	}
+
+	const SpatialGrid& VisibilityIndex::getGrid() const
+	{
+		return this->grid;
+	}
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
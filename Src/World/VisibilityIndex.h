@@ -0,0 +1,63 @@
+// Copyright (c) 2012-2017 Volodymyr Syvochka
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "math/Vec2.h"
+
+#include "SpatialGrid.h"
+
+namespace RioGame
+{
+
+	using ::RioEngine::Vec2;
+
+	class EntityManager;
+	class ChangeTracker;
+
+	// Entities inside the camera's view rectangle, recomputed every tick from a spatial grid of
+	// the PhysicsComponent positions (kept up to date through the ChangeTracker)
+	// Positions only reach the grid when they are reported: units moved by the MovementSystem are
+	// reported by the World at the end of the movement, other entities have to be moved with
+	// World::setPosition. Processed at the start of a tick, the grid then holds the positions the
+	// previous tick ended with
+	// Systems that only matter on screen (graphics, animation) iterate the visible entities, entities
+	// entering the view are listed separately so their state can be caught up lazily
+	// Without a view every entity counts as visible
+	class VisibilityIndex
+	{
+	public:
+		VisibilityIndex(EntityManager& entityManager, ChangeTracker& changes, float cellSize = 4.0f);
+		VisibilityIndex(const VisibilityIndex&) = delete;
+		VisibilityIndex& operator=(const VisibilityIndex&) = delete;
+		~VisibilityIndex();
+
+		// World rectangle seen by the camera, margin is added on all sides
+		void setView(const Vec2& min, const Vec2& max, float margin = 2.0f);
+		void clearView();
+		void process();
+
+		bool hasView() const;
+		bool isVisible(uint32_t entity) const;
+		// Visible entities sorted by id
+		const std::vector<uint32_t>& getVisible() const;
+		// Entities that became visible in the last process call, sorted by id
+		const std::vector<uint32_t>& getEntered() const;
+		const SpatialGrid& getGrid() const;
+	private:
+		EntityManager& entityManager;
+		ChangeTracker& changes;
+		uint32_t subscription;
+		SpatialGrid grid;
+
+		bool viewSet = false;
+		Vec2 viewMin;
+		Vec2 viewMax;
+		std::vector<uint32_t> visible;
+		std::vector<uint32_t> previous;
+		std::vector<uint32_t> entered;
+	};
+
+} // namespace RioGame
+// Copyright (c) 2012-2017 Volodymyr Syvochka
\ No newline at end of file
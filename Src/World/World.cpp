@@ -1,9 +1,14 @@
 // Copyright (c) 2012-2016 Volodymyr Syvochka
 #include "World.h"
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
 #include "base/Macros.h" // for RioAssert
 
 #include "Game.h"
+#include "Tools/Player.h"
 
 #include "Systems/HealthSystem.h"
 #include "Systems/MovementSystem.h"
@@ -20,45 +25,202 @@
 #include "Systems/ManaSpellSystem.h"
 #include "Systems/WaveSystem.h"
 #include "Systems/AnimationSystem.h"
+#include "Systems/ProjectileSystem.h"
+
+#include "AiScheduler.h"
+#include "ChunkStreamer.h"
+#include "LevelGenerators/ChunkedLevelGenerator.h"
 
 namespace RioGame
 {
 
-	World::World()
+	namespace
 	{
+		// Seconds between two regeneration ticks
+		const float regenInterval = 1.0f;
+		// Index of the atlas the AtlasPacker builds from the blueprints' sprites
+		const char* spriteAtlasIndex = "atlas/sprites.index";
+
+		const TimerType cooldownTimers[] = { TimerType::NOTIFICATION_COOLDOWN, TimerType::ON_HIT_COOLDOWN,
+			TimerType::SPELL_COOLDOWN, TimerType::TRIGGER_COOLDOWN, TimerType::PRODUCTION_COOLDOWN };
+
+		uint64_t getTimerKey(TimerType type, uint32_t entity)
+		{
+			return ((uint64_t)type << 32) | entity;
+		}
+
+		// Elapsed time, length and component type of the cooldown a timer type stands for
+		struct Cooldown
+		{
+			float* elapsed = nullptr;
+			float length = 0.0f;
+			uint32_t type = 0;
+		};
+
+		template<typename T>
+		Cooldown makeCooldown(T* component, float T::* elapsed)
+		{
+			Cooldown cooldown;
+			if (component != nullptr)
+			{
+				cooldown.elapsed = &(component->*elapsed);
+				cooldown.length = component->cooldown;
+				cooldown.type = T::type;
+			}
+			return cooldown;
+		}
+
+		Cooldown getCooldown(EntityManager& entityManager, TimerType type, uint32_t entity)
+		{
+			switch (type)
+			{
+			case TimerType::NOTIFICATION_COOLDOWN:
+				return makeCooldown(entityManager.getComponent<NotificationComponent>(entity), &NotificationComponent::currentTime);
+			case TimerType::ON_HIT_COOLDOWN:
+				return makeCooldown(entityManager.getComponent<OnHitComponent>(entity), &OnHitComponent::currentTime);
+			case TimerType::SPELL_COOLDOWN:
+				return makeCooldown(entityManager.getComponent<SpellComponent>(entity), &SpellComponent::cooldownTime);
+			case TimerType::TRIGGER_COOLDOWN:
+				return makeCooldown(entityManager.getComponent<TriggerComponent>(entity), &TriggerComponent::currentTime);
+			case TimerType::PRODUCTION_COOLDOWN:
+				return makeCooldown(entityManager.getComponent<ProductionComponent>(entity), &ProductionComponent::currentCooldown);
+			default:
+				return Cooldown{};
+			}
+		}
+	}
 
+	World::World()
+	{
+		initHandlers();
 	}
 
-	World::World(World&& rhs)
-		: entityManager(std::move(rhs.entityManager))
-		, delta(rhs.delta)
-		, aiSystem(std::move(rhs.aiSystem))
-		, animationSystem(std::move(rhs.animationSystem))
-		, combatSystem(std::move(rhs.combatSystem))
-		, inputSystem(std::move(rhs.inputSystem))
-		, movementSystem(std::move(rhs.movementSystem))
+	World::~World()
 	{
 
 	}
 
-	World& World::operator=(World&& rhs)
+	void World::initHandlers()
 	{
-#define DISABLE_TEMPORARILY 0
-#if DISABLE_TEMPORARILY
-		entityManager = std::move(rhs.entityManager);
-		delta = rhs.delta;
-		aiSystem = std::move(rhs.aiSystem);
-		animationSystem = std::move(rhs.animationSystem);
-		combatSystem = std::move(rhs.combatSystem);
-		inputSystem = std::move(rhs.inputSystem);
-		movementSystem = std::move(rhs.movementSystem);
-#endif DISABLE_TEMPORARILY
-		return *this;
+		blueprints.setChangeHandler([this](const BlueprintData& data) { rebake(data); });
+		// Entities already spawned from a removed blueprint stay, only the prefab goes
+		blueprints.setRemoveHandler([this](const std::string& name) { prefabs.remove(name); });
+		economy.setIncomeHandler([this](uint32_t gold)
+		{
+			resources.deposit(threadPool.getWorkerCount(), Resource::GOLD, gold);
+		});
+
+		// Same cadence for the player's mana and the health and mana of all entities
+		timingWheel.setHandler(TimerType::REGEN_TICK, [this](uint32_t)
+		{
+			regenDue = true;
+			if (game != nullptr && game->getPlayer() != nullptr)
+			{
+				resources.deposit(threadPool.getWorkerCount(), Resource::MANA, game->getPlayer()->getManaRegen());
+			}
+		});
+		timingWheel.schedule(TimerType::REGEN_TICK, Component::NO_ENTITY, regenInterval, regenInterval);
+
+		// Lifespans and time events get their deadline when the component is added
+		const uint8_t addedOrRemoved = (uint8_t)ChangeKind::ADDED | (uint8_t)ChangeKind::REMOVED;
+		changes.observe(LimitedLifeSpanComponent::type, addedOrRemoved, [this](uint32_t entity, ChangeKind kind)
+		{
+			auto lifeSpan = entityManager.getComponent<LimitedLifeSpanComponent>(entity);
+			if (kind == ChangeKind::ADDED && lifeSpan != nullptr)
+			{
+				scheduleTimer(TimerType::LIFE_SPAN, entity, lifeSpan->maxTime - lifeSpan->currentTime);
+			}
+			else if (kind == ChangeKind::REMOVED)
+			{
+				cancelTimer(TimerType::LIFE_SPAN, entity);
+			}
+		});
+		timingWheel.setHandler(TimerType::LIFE_SPAN, [this](uint32_t entity)
+		{
+			entityTimers.erase(getTimerKey(TimerType::LIFE_SPAN, entity));
+			auto lifeSpan = entityManager.getComponent<LimitedLifeSpanComponent>(entity);
+			if (lifeSpan != nullptr)
+			{
+				lifeSpan->currentTime = lifeSpan->maxTime;
+				destroyEntity(entity);
+			}
+		});
+
+		changes.observe(TimeComponent::type, addedOrRemoved, [this](uint32_t entity, ChangeKind kind)
+		{
+			auto timeComponent = entityManager.getComponent<TimeComponent>(entity);
+			if (kind == ChangeKind::ADDED && timeComponent != nullptr)
+			{
+				scheduleTimer(TimerType::TIME_EVENT, entity, timeComponent->timeLimit - timeComponent->currentTime);
+			}
+			else if (kind == ChangeKind::REMOVED)
+			{
+				cancelTimer(TimerType::TIME_EVENT, entity);
+			}
+		});
+		timingWheel.setHandler(TimerType::TIME_EVENT, [this](uint32_t entity)
+		{
+			entityTimers.erase(getTimerKey(TimerType::TIME_EVENT, entity));
+			auto timeComponent = entityManager.getComponent<TimeComponent>(entity);
+			if (timeComponent == nullptr)
+			{
+				return;
+			}
+
+			timeComponent->currentTime = timeComponent->timeLimit;
+			auto event = entityManager.getComponent<EventComponent>(timeComponent->target);
+			if (event != nullptr && (timeComponent->eventType == TimeEvent::START_EVENT || timeComponent->eventType == TimeEvent::END_EVENT))
+			{
+				event->active = timeComponent->eventType == TimeEvent::START_EVENT;
+				changes.markChanged<EventComponent>(timeComponent->target);
+			}
+			// The TimeSystem reacts to the change for CALL_FUNCTION
+			changes.markChanged<TimeComponent>(entity);
+		});
+
+		for (TimerType type : cooldownTimers)
+		{
+			timingWheel.setHandler(type, [this, type](uint32_t entity)
+			{
+				entityTimers.erase(getTimerKey(type, entity));
+				Cooldown cooldown = getCooldown(entityManager, type, entity);
+				if (cooldown.elapsed != nullptr)
+				{
+					// Ready again, the systems keep comparing the elapsed time with the cooldown
+					*cooldown.elapsed = cooldown.length;
+					changes.mark(entity, cooldown.type, ChangeKind::CHANGED);
+				}
+			});
+		}
 	}
 
-	World::~World()
+	void World::startCooldown(TimerType type, uint32_t entity)
 	{
+		Cooldown cooldown = getCooldown(entityManager, type, entity);
+		if (cooldown.elapsed == nullptr)
+		{
+			return;
+		}
+
+		*cooldown.elapsed = 0.0f;
+		scheduleTimer(type, entity, cooldown.length);
+	}
+
+	void World::scheduleTimer(TimerType type, uint32_t entity, float seconds)
+	{
+		auto inserted = entityTimers.emplace(getTimerKey(type, entity), uint32_t{ TimingWheel::NO_TIMER });
+		timingWheel.cancel(inserted.first->second);
+		inserted.first->second = timingWheel.schedule(type, entity, seconds);
+	}
 
+	void World::cancelTimer(TimerType type, uint32_t entity)
+	{
+		auto found = entityTimers.find(getTimerKey(type, entity));
+		if (found != entityTimers.end())
+		{
+			timingWheel.cancel(found->second);
+			entityTimers.erase(found);
+		}
 	}
 
 	void World::initSystems()
@@ -78,11 +240,13 @@ namespace RioGame
 		productionSystem.reset(new ProductionSystem{ *this });
 		timeSystem.reset(new TimeSystem{ *this });
 		aiSystem.reset(new AiSystem{ *this });
+		aiScheduler.reset(new AiScheduler{ entityManager });
 		graphicsSystem.reset(new GraphicsSystem{ *this });
 		triggerSystem.reset(new TriggerSystem{ *this });
 		manaSpellSystem.reset(new ManaSpellSystem{ *this });
 		waveSystem.reset(new WaveSystem{ *this });
 		animationSystem.reset(new AnimationSystem{ *this });
+		projectileSystem.reset(new ProjectileSystem{ *this, entityManager });
 #endif DISABLE_TEMPORARILY
 	}
 
@@ -109,15 +273,273 @@ namespace RioGame
 
 	void World::process()
 	{
+		auto frameStart = std::chrono::steady_clock::now();
+
+		time += delta;
+		changes.nextTick();
+		// No job is running between two ticks
+		syncResources();
+		// Prefabs of edited blueprints are swapped before anything gets spawned in this tick
+		blueprints.process();
+		timingWheel.advance(delta);
+		pathRequests.deliver();
+		if (chunkStreamer != nullptr)
+		{
+			chunkStreamer->update(focus);
+		}
+		// The thread pool is idle until the searches are dispatched at the end of this tick
+		threadArenas.reset();
+
 		inputSystem->process();
+		// The AiSystem only thinks for the entities scheduled by the AI level of detail in this frame
+		aiBatch.clear();
+		aiScheduler->process([this](uint32_t entity) { think(entity); });
 		aiSystem->process();
-		animationSystem->process();
+		behaviourTrees.getBlackboards().collect(entityManager, 64);
+		visibility.process();
+		// Triggers only react to the begin and end events of the overlaps
+		broadphase.process();
+		// Animation only needs to run for the entities on screen
+		if (visibility.hasView())
+		{
+			animations.update(entityManager, threadPool, visibility.getVisible(), visibility.getEntered(), time, delta);
+		}
+		else
+		{
+			animations.update(entityManager, threadPool, query<AnimationComponent>().getEntities(), {}, time, delta);
+		}
+		// Units avoid each other before they move
+		crowd.process(delta);
 		movementSystem->process();
-
-		// after processing all systems
+		// The MovementSystem writes the positions directly, the graphics sync, the visibility
+		// index and the broadphase only see what is reported
+		markMoved();
+		projectileSystem->process();
+		// Deaths are detected once, after all the damage of this tick
+		healthPass.process(regenDue);
+		regenDue = false;
+		for (const auto& death : healthPass.getDeaths())
+		{
+			// The cell a dead unit was moving into is free again
+			occupancy.release(death.entity);
+			if (deathHandler)
+			{
+				deathHandler(death);
+			}
+			// The destructor blueprint runs when the entity is destroyed at the end of the tick
+			scheduleToRemove(death.entity);
+		}
+		economy.update(delta, time);
+		graphicsSync.process();
+
+		// after processing all systems, the removed components are part of this tick's changes
+		removeScheduled();
+
+		// Observers react to the changes the systems made in this tick
+		changes.dispatch();
+
+		// Only entities the engine itself scheduled are left, the World's ones are gone already
 		entityManager.removeEntitiesScheduledToRemove();
 
 		entityManager.process();
+
+		// Allocations made after the reset (the path searches dispatched below) stay valid until the end of the next tick
+		frameArena.reset();
+
+		// Searches run in the background until the next tick
+		pathRequests.dispatch();
+
+		// Shrinks the AI think budget when the frame is over the target time
+		auto frameTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart);
+		aiScheduler->reportFrameTime(frameTime.count());
+	}
+
+	void World::setFocus(const Vec2& position)
+	{
+		this->focus = position;
+		if (aiScheduler != nullptr)
+		{
+			aiScheduler->setFocus(position);
+		}
+	}
+
+	ChunkStreamer& World::enableChunkStreaming(const std::string& storagePath)
+	{
+		chunkStreamer.reset(new ChunkStreamer{ *this, storagePath });
+		// Loaded and unloaded chunks change the node graph
+		chunkStreamer->setLoadHandler([this](uint32_t) { pathRequests.invalidateGraph(); });
+		chunkStreamer->setUnloadHandler([this](uint32_t) { pathRequests.invalidateGraph(); });
+		// Parked miners whose mine got paged out keep mining the chunk's summary
+		economy.setGoldSource([this](uint32_t mine, uint32_t amount) { return chunkStreamer->drawGold(mine, amount); });
+		return *chunkStreamer;
+	}
+
+	void World::setViewRect(const Vec2& min, const Vec2& max)
+	{
+		graphicsSync.setView(min, max);
+		visibility.setView(min, max);
+	}
+
+	AnimationLibrary& World::getAnimationLibrary()
+	{
+		return animations;
+	}
+
+	float World::getTime()
+	{
+		return time;
+	}
+
+	VisibilityIndex& World::getVisibilityIndex()
+	{
+		return visibility;
+	}
+
+	Broadphase& World::getBroadphase()
+	{
+		return broadphase;
+	}
+
+	CrowdSteering& World::getCrowdSteering()
+	{
+		return crowd;
+	}
+
+	GraphicsSync& World::getGraphicsSync()
+	{
+		return graphicsSync;
+	}
+
+	SpriteAtlas& World::getSpriteAtlas()
+	{
+		return spriteAtlas;
+	}
+
+	void World::setLayer(Node* layer)
+	{
+		spriteAtlas.clear();
+		// Without an atlas every sprite gets its own texture
+		if (std::ifstream{ spriteAtlasIndex })
+		{
+			spriteAtlas.load(spriteAtlasIndex, layer);
+		}
+		if (projectileSystem != nullptr)
+		{
+			projectileSystem->setLayer(layer);
+		}
+	}
+
+	const std::vector<HealthPass::Death>& World::getDeaths() const
+	{
+		return healthPass.getDeaths();
+	}
+
+	void World::setDeathHandler(const std::function<void(const HealthPass::Death&)>& handler)
+	{
+		this->deathHandler = handler;
+	}
+
+	void World::syncResources()
+	{
+		resources.commit();
+		if (game == nullptr || game->getPlayer() == nullptr)
+		{
+			return;
+		}
+
+		Player& player = *game->getPlayer();
+		// A spend the Player can't cover anymore (it was changed directly since the last sync) takes
+		// what is there, the rest is reported as overdraft
+		auto apply = [this, &player](Resource resource, uint32_t available
+			, void (Player::*add)(uint32_t), bool (Player::*subtract)(uint32_t))
+		{
+			int64_t change = resources.takeChange(resource);
+			if (change > 0)
+			{
+				(player.*add)((uint32_t)change);
+			}
+			else if (change < 0 && !(player.*subtract)((uint32_t)-change))
+			{
+				(player.*subtract)(available);
+				if (overdraftHandler)
+				{
+					overdraftHandler(resource, (uint32_t)(-change - available));
+				}
+			}
+		};
+		apply(Resource::GOLD, player.getGold(), &Player::addGold, &Player::subtractGold);
+		apply(Resource::MANA, player.getMana(), &Player::addMana, &Player::subtractMana);
+		apply(Resource::UNITS, player.getCurrentUnitCount(), &Player::addCurrentUnit, &Player::subtractCurrentUnit);
+
+		// Changes made on the Player directly since the last sync are picked up
+		resources.reset(Resource::GOLD, player.getGold());
+		resources.reset(Resource::MANA, player.getMana(), player.getMaxMana());
+		resources.reset(Resource::UNITS, player.getCurrentUnitCount(), player.getMaxUnitCount());
+	}
+
+	ResourceLedger& World::getResourceLedger()
+	{
+		return resources;
+	}
+
+	void World::setOverdraftHandler(const std::function<void(Resource, uint32_t)>& handler)
+	{
+		this->overdraftHandler = handler;
+	}
+
+	EconomyModel& World::getEconomyModel()
+	{
+		return economy;
+	}
+
+	ChunkStreamer* World::getChunkStreamer()
+	{
+		return chunkStreamer.get();
+	}
+
+	void World::rebake(const BlueprintData& data)
+	{
+		if (!blueprintBuilder)
+		{
+			return;
+		}
+
+		// Entities already spawned keep their components, only new spawns use the new data
+		uint32_t templateEntity = blueprintBuilder(data);
+		animations.loadBlueprint(data);
+		auto animation = entityManager.getComponent<AnimationComponent>(templateEntity);
+		if (animation != nullptr)
+		{
+			// Clips are redefined in place, so spawned entities pick up the new frames too
+			animation->clipSet = animations.getClipSet(data.name);
+		}
+		auto ai = entityManager.getComponent<AiComponent>(templateEntity);
+		const std::string* tree = data.find("Ai.tree");
+		if (ai != nullptr && tree != nullptr)
+		{
+			// Unknown trees leave the entities to the AiSystem
+			ai->behaviourTree = behaviourTrees.getTreeId(*tree);
+		}
+		prefabs.bake(data.name, templateEntity);
+		discardEntity(templateEntity);
+	}
+
+	void World::think(uint32_t entity)
+	{
+		auto ai = entityManager.getComponent<AiComponent>(entity);
+		// Parked miners are simulated by the economy model
+		if (ai == nullptr || economy.isParked(entity))
+		{
+			return;
+		}
+
+		if (ai->behaviourTree != BehaviourTreeLibrary::NO_TREE)
+		{
+			behaviourTrees.execute(ai->behaviourTree, entity, entityManager);
+			return;
+		}
+
+		aiBatch.push_back(entity);
 	}
 
 	EntityManager& World::getEntityManager()
@@ -125,12 +547,212 @@ namespace RioGame
 		return entityManager;
 	}
 
+	TimingWheel& World::getTimingWheel()
+	{
+		return timingWheel;
+	}
+
+	ThreadPool& World::getThreadPool()
+	{
+		return threadPool;
+	}
+
+	LinearArena& World::getFrameArena()
+	{
+		return frameArena;
+	}
+
+	ThreadArenas& World::getThreadArenas()
+	{
+		return threadArenas;
+	}
+
+	PathRequestQueue& World::getPathRequestQueue()
+	{
+		return pathRequests;
+	}
+
+	void World::setNodeFree(uint32_t node, bool free)
+	{
+		auto gridNode = entityManager.getComponent<GridNodeComponent>(node);
+		if (gridNode != nullptr && gridNode->free != free)
+		{
+			gridNode->free = free;
+			changes.markChanged<GridNodeComponent>(node);
+			if (gridNode->x < occupancy.getWidth() && gridNode->y < occupancy.getHeight())
+			{
+				occupancy.setWall(gridNode->x, gridNode->y, !free);
+			}
+		}
+	}
+
+	void World::destroyEntity(uint32_t entity)
+	{
+		auto destructor = entityManager.getComponent<DestructorComponent>(entity);
+		if (destructor != nullptr)
+		{
+			auto dtor = destructor->blueprint.find("dtor");
+			if (dtor != destructor->blueprint.end() && dtor->second)
+			{
+				dtor->second();
+			}
+		}
+		discardEntity(entity);
+	}
+
+	void World::discardEntity(uint32_t entity)
+	{
+		auto signature = queries.getSignature(entity);
+		for (uint32_t type = 0; type < signature.size(); ++type)
+		{
+			if (signature.test(type))
+			{
+				changes.mark(entity, type, ChangeKind::REMOVED);
+			}
+		}
+
+		entityManager.destroyEntity(entity);
+		queries.entityDestroyed(entity);
+	}
+
+	void World::scheduleToRemove(uint32_t entity)
+	{
+		scheduledRemovals.push_back(entity);
+	}
+
+	void World::removeScheduled()
+	{
+		// An entity can be scheduled more than once in a tick, it's only destroyed once
+		std::sort(scheduledRemovals.begin(), scheduledRemovals.end());
+		scheduledRemovals.erase(std::unique(scheduledRemovals.begin(), scheduledRemovals.end()), scheduledRemovals.end());
+		for (uint32_t entity : scheduledRemovals)
+		{
+			destroyEntity(entity);
+		}
+		scheduledRemovals.clear();
+	}
+
+	void World::registerEntity(uint32_t entity)
+	{
+		queries.refresh(entity, entityManager);
+		auto signature = queries.getSignature(entity);
+		for (uint32_t type = 0; type < signature.size(); ++type)
+		{
+			if (signature.test(type))
+			{
+				changes.mark(entity, type, ChangeKind::ADDED);
+			}
+		}
+	}
+
+	void World::createLevel(LevelGenerators::ChunkedLevelGenerator& generator, float tileSize)
+	{
+		std::vector<uint32_t> created;
+		generator.createEntities(entityManager, created, tileSize);
+		for (uint32_t entity : created)
+		{
+			registerEntity(entity);
+		}
+		occupancy.build(entityManager);
+	}
+
+	void World::setPosition(uint32_t entity, const Vec2& position)
+	{
+		auto physics = entityManager.getComponent<PhysicsComponent>(entity);
+		if (physics != nullptr)
+		{
+			physics->position = position;
+			changes.markChanged<PhysicsComponent>(entity);
+		}
+	}
+
+	void World::markMoved()
+	{
+		// Units only move with a steered velocity, so the crowd's agents are the only candidates
+		const auto& agents = crowd.getAgents();
+		for (uint32_t i = 0; i < agents.size(); ++i)
+		{
+			auto physics = entityManager.getComponent<PhysicsComponent>(agents[i]);
+			Vec2 steeredAt = crowd.getAgentPosition(i);
+			if (physics != nullptr && (physics->position.x != steeredAt.x || physics->position.y != steeredAt.y))
+			{
+				changes.markChanged<PhysicsComponent>(agents[i]);
+			}
+		}
+	}
+
+	QueryCache& World::getQueryCache()
+	{
+		return queries;
+	}
+
+	ChangeTracker& World::getChangeTracker()
+	{
+		return changes;
+	}
+
+	GroupCommandPlanner& World::getGroupCommandPlanner()
+	{
+		return commands;
+	}
+
+	OccupancyMap& World::getOccupancyMap()
+	{
+		return occupancy;
+	}
+
+	PrefabLibrary& World::getPrefabLibrary()
+	{
+		return prefabs;
+	}
+
+	bool World::instantiate(const std::string& blueprint, uint32_t count, const Vec2* positions, std::vector<uint32_t>& created)
+	{
+		size_t first = created.size();
+		if (!prefabs.instantiate(blueprint, count, positions, created))
+		{
+			return false;
+		}
+
+		for (size_t i = first; i < created.size(); ++i)
+		{
+			registerEntity(created[i]);
+		}
+		return true;
+	}
+
+	BlueprintPipeline& World::getBlueprintPipeline()
+	{
+		return blueprints;
+	}
+
+	void World::setBlueprintBuilder(const std::function<uint32_t(const BlueprintData&)>& builder)
+	{
+		this->blueprintBuilder = builder;
+	}
+
 	AiSystem& World::getAiSystem()
 	{
 		RioAssert(aiSystem != nullptr, "aiSystem == nullptr");
 		return *aiSystem.get();
 	}
 
+	const std::vector<uint32_t>& World::getAiBatch() const
+	{
+		return aiBatch;
+	}
+
+	AiScheduler& World::getAiScheduler()
+	{
+		RioAssert(aiScheduler != nullptr, "aiScheduler == nullptr");
+		return *aiScheduler.get();
+	}
+
+	BehaviourTreeLibrary& World::getBehaviourTreeLibrary()
+	{
+		return behaviourTrees;
+	}
+
 	AnimationSystem& World::getAnimationSystem()
 	{
 		RioAssert(animationSystem != nullptr, "animationSystem == nullptr");
@@ -173,6 +795,12 @@ namespace RioGame
 		return *waveSystem.get();
 	}
 
+	ProjectileSystem& World::getProjectileSystem()
+	{
+		RioAssert(projectileSystem != nullptr, "projectileSystem == nullptr");
+		return *projectileSystem.get();
+	}
+
 	EventSystem& World::getEventSystem()
 	{
 		RioAssert(eventSystem != nullptr, "eventSystem == nullptr");
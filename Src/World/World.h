@@ -2,6 +2,26 @@
 #pragma once
 #include "Common.h"
 #include "EntityManager.h"
+#include "TimingWheel.h"
+#include "Ai/BehaviourTreeLibrary.h"
+#include "Tools/LinearArena.h"
+#include "Tools/ThreadPool.h"
+#include "PathRequestQueue.h"
+#include "PrefabLibrary.h"
+#include "OccupancyMap.h"
+#include "Query.h"
+#include "ChangeTracker.h"
+#include "GraphicsSync.h"
+#include "VisibilityIndex.h"
+#include "Broadphase.h"
+#include "CrowdSteering.h"
+#include "GroupCommandPlanner.h"
+#include "AnimationLibrary.h"
+#include "HealthPass.h"
+#include "EconomyModel.h"
+#include "Tools/BlueprintPipeline.h"
+#include "Tools/SpriteAtlas.h"
+#include "Tools/ResourceLedger.h"
 
 namespace RioGame
 {
@@ -22,6 +42,14 @@ namespace RioGame
 	class TriggerSystem;
 	class ManaSpellSystem;
 	class WaveSystem;
+	class ProjectileSystem;
+	class AiScheduler;
+	class ChunkStreamer;
+
+	namespace LevelGenerators
+	{
+		class ChunkedLevelGenerator;
+	}
 
 	class Game;
 
@@ -31,8 +59,9 @@ namespace RioGame
 		World();
 		World& operator=(const World& rhs) = delete;
 		World(const World& rhs) = delete;
-		World(World&& rhs);
-		World& operator=(World&& rhs);
+		// The parts of the World hold references to each other and to the World, it stays where it was built
+		World(World&& rhs) = delete;
+		World& operator=(World&& rhs) = delete;
 		~World();
 
 		void init(Game* game);
@@ -42,8 +71,124 @@ namespace RioGame
 		void setDelta(float delta);
 		void process();
 		EntityManager& getEntityManager();
+		// Deadlines of timers, cooldowns and lifespans, advanced at the start of every process call
+		TimingWheel& getTimingWheel();
+		// Restarts a cooldown of the entity (the *_COOLDOWN timer types), its timer sets it ready again
+		void startCooldown(TimerType type, uint32_t entity);
+		ThreadPool& getThreadPool();
+		// Arena for data that lives at most until the end of the next tick (reset once per tick)
+		LinearArena& getFrameArena();
+		// Arenas of the thread pool's threads, reset at the start of every tick while no job is running
+		ThreadArenas& getThreadArenas();
+		// Paths requested during a tick are delivered at the start of the next one
+		PathRequestQueue& getPathRequestQueue();
+		// Blocks or frees a grid node, the searches dispatched from then on see the change
+		void setNodeFree(uint32_t node, bool free);
+		// Commands given to a selected group, one shared path and a formation per command
+		GroupCommandPlanner& getGroupCommandPlanner();
+		// Units, structures and claimed cells of the grid, built by createLevel, in the chunked mode sized
+		// by ChunkStreamer::init and filled as chunks are paged in, setNodeFree keeps the walls up to date
+		OccupancyMap& getOccupancyMap();
+		// Entities having all the components Ts, narrowed with without<...>(), served from cached views
+		template<typename... Ts>
+		Query<Ts...> query()
+		{
+			return Query<Ts...>{ queries, entityManager, threadPool };
+		}
+
+		// Component changes made through the following are seen by the queries and the change tracker
+		template<typename T>
+		void addComponent(uint32_t entity, const T& component)
+		{
+			entityManager.addComponent<T>(entity, component);
+			queries.componentAdded(entity, T::type);
+			changes.markAdded<T>(entity);
+		}
+
+		template<typename T>
+		void deleteComponent(uint32_t entity)
+		{
+			entityManager.deleteComponent<T>(entity);
+			queries.componentRemoved(entity, T::type);
+			changes.markRemoved<T>(entity);
+		}
+
+		// Runs the entity's destructor blueprint ("dtor") and destroys it
+		void destroyEntity(uint32_t entity);
+		// Destroys the entity without its destructor blueprint, for entities that don't end in the game
+		// (blueprint templates, the entities of a paged out chunk)
+		void discardEntity(uint32_t entity);
+		// Destroys the entity through destroyEntity at the end of the tick, before the observers run
+		// Systems remove entities this way instead of scheduling them on the EntityManager, which
+		// wouldn't tell the queries and the change tracker
+		void scheduleToRemove(uint32_t entity);
+		// Entities built directly on the EntityManager (the EntityCreator, level generators) enter the
+		// queries and report their components as added
+		void registerEntity(uint32_t entity);
+		// Creates the entities of a generated level, registers them and builds the occupancy map
+		void createLevel(LevelGenerators::ChunkedLevelGenerator& generator, float tileSize = 1.0f);
+		// Moves the entity and reports it, so its node, its visibility and its overlaps follow
+		// (units moved by the MovementSystem are reported by the World itself)
+		void setPosition(uint32_t entity, const Vec2& position);
+		QueryCache& getQueryCache();
+		// Systems writing to a component report it with markChanged<T>, observers run at the end of the tick
+		ChangeTracker& getChangeTracker();
+
+		// Blueprints baked once, spawned in bulk
+		PrefabLibrary& getPrefabLibrary();
+		// Spawns count entities of a baked blueprint (see Prefab::instantiate) and registers them with the queries
+		bool instantiate(const std::string& blueprint, uint32_t count, const Vec2* positions, std::vector<uint32_t>& created);
+		// Blueprint data files, changed blueprints are re-baked at the start of the next tick
+		BlueprintPipeline& getBlueprintPipeline();
+		// Builds a template entity from blueprint data (done by the EntityCreator), used to bake prefabs
+		void setBlueprintBuilder(const std::function<uint32_t(const BlueprintData&)>& builder);
+		// Position of the camera on the ground plane, the AI level of detail and chunk streaming work around it
+		void setFocus(const Vec2& position);
+		// Switches to the chunked world mode, paged out chunks are kept in the file at storagePath
+		ChunkStreamer& enableChunkStreaming(const std::string& storagePath);
+		// Part of the world seen by the camera (the main Camera's view rectangle on the ground plane),
+		// nodes outside of it aren't updated
+		void setViewRect(const Vec2& min, const Vec2& max);
+		// Entities in the view rectangle, recomputed every tick
+		VisibilityIndex& getVisibilityIndex();
+		// Entities entering and leaving the radius of triggers and events, updated every tick
+		Broadphase& getBroadphase();
+		// Local avoidance, the MovementSystem reports the velocities units want and moves them with the steered ones
+		CrowdSteering& getCrowdSteering();
+		// Pushes the changes of a tick to the scene nodes
+		GraphicsSync& getGraphicsSync();
+		// Animation clips of the blueprints, loaded with the blueprint data
+		AnimationLibrary& getAnimationLibrary();
+		// Simulated time, the sum of the deltas of all processed ticks
+		float getTime();
+		// Packed entity sprites, drawn in one batch per atlas page
+		SpriteAtlas& getSpriteAtlas();
+		// Scene layer the entities' nodes are added to, loads the sprite atlas written by the
+		// AtlasPacker (if there is one) into it
+		void setLayer(Node* layer);
+		// Entities that died in this tick (after the damage of all systems), sorted by id
+		const std::vector<HealthPass::Death>& getDeaths() const;
+		// Called for every death, pays out the experience, the entity is destroyed at the end of the tick
+		void setDeathHandler(const std::function<void(const HealthPass::Death&)>& handler);
+		// Gold, mana and units of the player for the systems running in parallel, merged into the Player
+		// at the start of every tick (the Player itself must only be changed from the main thread)
+		ResourceLedger& getResourceLedger();
+		// Called with the part of a ledger spend the Player couldn't cover at the sync, because the Player
+		// was changed directly in the meantime, the Player is charged what it had
+		void setOverdraftHandler(const std::function<void(Resource, uint32_t deficit)>& handler);
+		// Gold mining loops of off-screen miners, simulated as income per second
+		EconomyModel& getEconomyModel();
+		// Returns nullptr unless chunk streaming is enabled
+		ChunkStreamer* getChunkStreamer();
 
 		AiSystem& getAiSystem();
+		AiScheduler& getAiScheduler();
+		// Entities without a behaviour tree the AiScheduler picked in this tick, the AiSystem's process
+		// thinks for these only
+		const std::vector<uint32_t>& getAiBatch() const;
+		// Trees have to be loaded before the blueprints, a blueprint's "Ai.tree <name>" property gives
+		// the entities spawned from it that tree
+		BehaviourTreeLibrary& getBehaviourTreeLibrary();
 		AnimationSystem& getAnimationSystem();
 		CombatSystem& getCombatSystem();
 		EventSystem& getEventSystem();
@@ -57,9 +202,28 @@ namespace RioGame
 		TriggerSystem& getTriggerSystem();
 
 		WaveSystem& getWaveSystem();
+		ProjectileSystem& getProjectileSystem();
 
 		Game& getGame();
 	private:
+		// Runs the behaviour tree of an entity scheduled by the AiScheduler, entities without one
+		// are added to the AiSystem's batch
+		void think(uint32_t entity);
+		// Replaces the prefab of a loaded or reloaded blueprint
+		void rebake(const BlueprintData& data);
+		// Handlers of the World's own timers and parts, called from the constructor
+		void initHandlers();
+		// Applies the ledger's changes to the Player and reloads the ledger from it
+		void syncResources();
+		// Destroys the entities scheduled to be removed in this tick
+		void removeScheduled();
+		// Marks the PhysicsComponent of the units the MovementSystem moved in this tick as changed,
+		// only the crowd's agents of this tick are looked at
+		void markMoved();
+		// Timers of the entities' components, at most one per timer type and entity
+		void scheduleTimer(TimerType type, uint32_t entity, float seconds);
+		void cancelTimer(TimerType type, uint32_t entity);
+
 		Game* game = nullptr;
 
 		// main manager
@@ -67,6 +231,42 @@ namespace RioGame
 
 		// update interval
 		float delta = 0.0f;
+		float time = 0.0f;
+
+		TimingWheel timingWheel;
+		// Handle of the pending timer per (timer type << 32 | entity)
+		std::unordered_map<uint64_t, uint32_t> entityTimers;
+		// Compiled behaviour trees shared by all entities and their blackboards
+		BehaviourTreeLibrary behaviourTrees;
+
+		// Workers shared by the parallel parts of the simulation
+		ThreadPool threadPool;
+		LinearArena frameArena;
+		ThreadArenas threadArenas{ threadPool.getThreadCount() };
+		QueryCache queries;
+		ChangeTracker changes;
+		PathRequestQueue pathRequests{ entityManager, changes, threadPool, frameArena, threadArenas };
+		OccupancyMap occupancy;
+		PrefabLibrary prefabs{ entityManager };
+		SpriteAtlas spriteAtlas;
+		GraphicsSync graphicsSync{ entityManager, changes, spriteAtlas };
+		VisibilityIndex visibility{ entityManager, changes };
+		Broadphase broadphase{ entityManager, changes, visibility.getGrid(), frameArena };
+		CrowdSteering crowd{ entityManager, threadPool, visibility.getGrid() };
+		GroupCommandPlanner commands{ *this };
+		AnimationLibrary animations;
+		HealthPass healthPass{ entityManager, threadPool, changes };
+		EconomyModel economy{ entityManager, changes, visibility };
+		ResourceLedger resources{ threadPool.getThreadCount() };
+		std::function<void(const HealthPass::Death&)> deathHandler;
+		std::function<void(Resource, uint32_t)> overdraftHandler;
+		// Set by the REGEN_TICK timer, health and mana regenerate in the next health pass
+		bool regenDue = false;
+		BlueprintPipeline blueprints;
+		std::function<uint32_t(const BlueprintData&)> blueprintBuilder;
+		Vec2 focus;
+		std::vector<uint32_t> aiBatch;
+		std::vector<uint32_t> scheduledRemovals;
 
 		// systems
 		unique_ptr<HealthSystem> healthSystem;
@@ -84,6 +284,10 @@ namespace RioGame
 		unique_ptr<ManaSpellSystem> manaSpellSystem;
 		unique_ptr<WaveSystem> waveSystem;
 		unique_ptr<AnimationSystem> animationSystem;
+		unique_ptr<ProjectileSystem> projectileSystem;
+
+		unique_ptr<AiScheduler> aiScheduler;
+		unique_ptr<ChunkStreamer> chunkStreamer;
 	};
 
 } // namespace RioGame